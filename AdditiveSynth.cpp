@@ -1,14 +1,32 @@
 #include "AdditiveSynth.h"
 #include <stdio.h>
 
+#include "Tuning.h"
+
 // Constructor
 AdditiveSynth::AdditiveSynth() {
     initializeADSR(); // Initialize ADSR settings
+    harmonics.reserve(Tuning::maxDegrees); // setChord() then never allocates
 
     // 🎛 Initialize Low-Pass Filter for smoother sound
-    lowPassFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-    lowPassFilter.setCutoffFrequency(2000.0f); // Default 2kHz cutoff
-    lowPassFilter.setResonance(0.7f);
+    prepare(44100.0);
+    updateVoices(); // one voice, no spread
+}
+
+void AdditiveSynth::prepare(double newSampleRate, int maximumBlockSize) {
+    sampleRate = newSampleRate;
+    blockCapacity = juce::jmax(1, maximumBlockSize);
+    for (auto* v : {&sineGain, &sawGain, &triGain, &pitchRatio})
+        v->assign(static_cast<size_t>(blockCapacity), 0.0f);
+    groupBuffers.assign(static_cast<size_t>(2 * pool->getNumWorkers()),
+                        std::vector<float>(static_cast<size_t>(blockCapacity)));
+
+    for (auto& h : harmonics) updateIncrements(h);
+    setPanning(panSpread, panRate);
+
+    lowPassFilter.prepare(sampleRate, 2);
+    setFilterCutoff(filterCutoff); // Default 2kHz cutoff
+    setFilterResonance(filterResonance);
 }
 
 
@@ -24,75 +42,254 @@ void AdditiveSynth::initializeADSR() {
 
 // Set Pentatonic Chord Harmonics
 void AdditiveSynth::setPentatonicChord(float baseFreq) {
-    harmonics.clear();
-    float ratios[] = {1.0f, 9.0f/8.0f, 5.0f/4.0f, 3.0f/2.0f, 5.0f/3.0f, 2.0f}; 
+    const auto& scale = Tuning::getScale(Tuning::majorPentatonic, Tuning::just);
+    setChord(baseFreq, scale.ratios.data(), scale.size);
+}
 
-    for (float r : ratios) {
-        float detuneFactor = 1.0f + (juce::Random::getSystemRandom().nextFloat() * 0.02f - 0.01f); // ±1% detune
-        harmonics.push_back({baseFreq * r * detuneFactor, 0.2f, 0.0f});
+void AdditiveSynth::setChord(float baseFreq, const float* ratios, int numRatios) {
+    harmonics.clear();
+    for (int i = 0; i < numRatios; ++i) {
+        float detuneFactor = 1.0f + random.bipolar() * 0.01f; // ±1% detune
+        // the places on the pan orbit step by the golden ratio of a turn,
+        // so any number of partials comes out evenly spread
+        auto pan = static_cast<uint32_t>(i) * 0x9e3779b9u;
+        Harmonic h{baseFreq * ratios[i] * detuneFactor, 0.2f, pan, {}, {}};
+        for (size_t v = 1; v < maxUnison; ++v) h.phase[v] = phases.bits();
+        updateIncrements(h);
+        harmonics.push_back(h);
     }
 }
 
-// 🎵 Process Audio (Generate Next Sample)
-float AdditiveSynth::process(float sampleRate) {
-    float sample = 0.0f;
+// 🎵 Render a block: the partials first (split across the pool when the
+// chord is big enough), then the envelope, filter and clipping on the sum
+void AdditiveSynth::render(float* left, float* right, int numSamples, const Controls& controls) {
+    for (int done = 0; done < numSamples;) {
+        int count = juce::jmin(numSamples - done, blockCapacity);
 
-    // 🌊 LFO for slow pitch modulation
-    float lfo = std::sin(lfoPhase * juce::MathConstants<float>::twoPi) * lfoDepth;
-    lfoPhase += lfoSpeed / sampleRate;
-    if (lfoPhase >= 1.0f) lfoPhase -= 1.0f; // Keep LFO phase in range
+        // the curves, turned into what every partial needs per sample
+        for (int i = 0; i < count; ++i) {
+            auto at = [i, done](const float* curve, float held) {
+                return curve != nullptr ? curve[done + i] : held;
+            };
+            auto k = static_cast<size_t>(i);
+            sineGain[k] = 0.33f * juce::jlimit(0.0f, 1.0f, at(controls.sineMix, sineMix));
+            sawGain[k] = 0.33f * juce::jlimit(0.0f, 1.0f, at(controls.sawMix, sawMix));
+            triGain[k] = 0.33f * juce::jlimit(0.0f, 1.0f, at(controls.triMix, triMix));
+            pitchRatio[k] = 1.0f + at(controls.pitch, pitchModulation);
+        }
 
-    for (auto& h : harmonics) {
-        // ✅ Ensure each harmonic has its own phase
-        h.phase += h.frequency / sampleRate;
-        if (h.phase >= 1.0f) h.phase -= 1.0f;
+        renderPartials(left + done, right + done, count);
+        finish(left + done, right + done, count,
+               controls.cutoff != nullptr ? controls.cutoff + done : nullptr);
+        done += count;
+    }
+}
 
-        float modulatedFreq = h.frequency * (1.0f + lfo);
-        float harmonicPhase = h.phase;
-        h.phase += modulatedFreq / sampleRate;
-        if (h.phase >= 1.0f) h.phase -= 1.0f;
-        
-        float sineWave = std::sin(h.phase * juce::MathConstants<float>::twoPi);
-        float sawWave = 2.0f * (h.phase - std::floor(h.phase + 0.5f));
-        float triWave = std::abs(4.0f * (h.phase - std::floor(h.phase + 0.5f)) - 1.0f);
+void AdditiveSynth::renderPartials(float* left, float* right, int numSamples) {
+    int partials = getNumHarmonics();
+    int work = partials * numSamples * unisonVoices;
+    int groups = juce::jlimit(1, juce::jmin(threadLimit, static_cast<int>(groupBuffers.size()) / 2 + 1),
+                              work / minimumTaskWork);
+    groups = juce::jmin(groups, juce::jmax(1, partials));
 
+    Job job{this, left, right, numSamples, groups};
+    pool->run(renderGroup, &job, groups);
 
-        // 🏗️ Improved Mixing Strategy
-        //float mixedWave = (0.3f * sineWave) + (0.5f * sawWave) + (0.2f * triWave);
-        float mixedWave = (sineMix * 0.33 * sineWave) + (sawMix * 0.33 * sawWave) + (triMix * 0.33 * triWave);
+    for (int g = 1; g < groups; ++g) {
+        auto b = static_cast<size_t>(2 * (g - 1));
+        juce::FloatVectorOperations::add(left, groupBuffers[b].data(), numSamples);
+        juce::FloatVectorOperations::add(right, groupBuffers[b + 1].data(), numSamples);
+    }
+    panPhase += panStep * static_cast<uint32_t>(numSamples);
+}
 
-        sample += mixedWave * h.amplitude;
+// One group of partials into its own buffers. Runs on any thread, so it only
+// touches its own partials and buffers; the rest is read-only while it runs.
+void AdditiveSynth::renderGroup(void* context, int index) {
+    auto& job = *static_cast<Job*>(context);
+    auto& synth = *job.synth;
+    float* left = job.left;
+    float* right = job.right;
+    if (index > 0) {
+        left = synth.groupBuffers[static_cast<size_t>(2 * (index - 1))].data();
+        right = synth.groupBuffers[static_cast<size_t>(2 * (index - 1) + 1)].data();
     }
+    juce::FloatVectorOperations::clear(left, job.numSamples);
+    juce::FloatVectorOperations::clear(right, job.numSamples);
+
+    const int partials = synth.getNumHarmonics();
+    const int first = partials * index / job.numTasks;
+    const int last = partials * (index + 1) / job.numTasks;
+
+    // a single voice stays scalar
+    for (int p = first; p < last; ++p) {
+        auto& h = synth.harmonics[static_cast<size_t>(p)];
+        if (synth.unisonVoices == 1)
+            synth.renderPartial(h, left, right, job.numSamples);
+        else
+            synth.renderUnison(h, left, right, job.numSamples);
+    }
+}
+
+// sin(2 pi phase) from the shared table: the top bits of the phase are the
+// index, the rest the fraction to interpolate by
+float AdditiveSynth::lookup(const SharedAssets::Wavetable& sine, uint32_t phase) {
+    static_assert(SharedAssets::wavetableSize == 1 << tableBits);
+    constexpr int fractionBits = 32 - tableBits;
+    auto index = static_cast<size_t>(phase >> fractionBits);
+    float fraction = static_cast<float>(phase & ((1u << fractionBits) - 1)) * (1.0f / (1u << fractionBits));
+    return sine[index] + fraction * (sine[index + 1] - sine[index]);
+}
+
+// the phase as a signed fraction of a cycle, -0.5..0.5: the saw, halved
+float AdditiveSynth::centred(uint32_t phase) {
+    return static_cast<float>(static_cast<int32_t>(phase)) * 0x1p-32f;
+}
+
+uint32_t AdditiveSynth::increment(double step, float pitchRatio) {
+    return static_cast<uint32_t>(static_cast<uint64_t>(step * pitchRatio));
+}
 
-    // Normalize Sample to Prevent Clipping
-    sample *= 0.5f;
+void AdditiveSynth::updateIncrements(Harmonic& h) const {
+    const double cycle = 4294967296.0 / sampleRate; // 2^32 per cycle
+    for (size_t v = 0; v < maxUnison; ++v)
+        h.step[v] = h.frequency * voiceRatio[v] * cycle;
+}
 
-    // 🎛 Apply ADSR Envelope
-    sample *= adsr.getNextSample();
+// Where the partial sits, -1..1, `sample` samples into the block
+float AdditiveSynth::panPosition(const Harmonic& h, int sample) const {
+    const uint32_t orbit = panPhase + panStep * static_cast<uint32_t>(sample);
+    return panSpread * lookup(assets->getSine(), h.pan + orbit);
+}
 
-    // ✅ Apply Low-Pass Filter (Ensure Smoother Sound)
-    sample = lowPassFilter.processSample(0, sample);
+// Equal-power gains of one voice of a partial, from the same sine table: the
+// pan angle runs over a quarter turn, so the power sums to the same anywhere.
+// Scaled by sqrt 2 to keep the middle at unity, as before panning.
+void AdditiveSynth::panGains(const Harmonic& h, size_t voice, float position, float& left,
+                             float& right) const {
+    const auto& sine = assets->getSine();
+    const float pan = juce::jlimit(-1.0f, 1.0f, position + voicePan[voice]);
+    const auto angle = static_cast<uint32_t>((pan + 1.0f) * 536870912.0f); // (pan + 1) / 8 of a turn
+    const float gain = juce::MathConstants<float>::sqrt2 * h.amplitude * voiceLevel[voice];
+    left = gain * lookup(sine, angle + 0x40000000u); // cos
+    right = gain * lookup(sine, angle);
+}
 
-    
-    
+// One partial, one voice: an add and a lookup per sample, with the increment
+// and pan gains updated once per control interval for the pitch modulation
+// and pan motion
+void AdditiveSynth::renderPartial(Harmonic& h, float* left, float* right, int numSamples) const {
+    const auto& sine = assets->getSine();
+    float gainLeft = 0.0f, gainRight = 0.0f;
+    uint32_t phase = h.phase[0];
 
-    sample *= 3.0f;
+    for (int start = 0; start < numSamples; start += controlInterval) {
+        const int end = juce::jmin(numSamples, start + controlInterval);
+        const uint32_t step = increment(h.step[0], pitchRatio[static_cast<size_t>(start)]);
+        if (start == 0 || panStep != 0)
+            panGains(h, 0, panPosition(h, start), gainLeft, gainRight);
+        for (int i = start; i < end; ++i) {
+            const auto k = static_cast<size_t>(i);
+            phase += step; // wraps by itself
 
-    
-    //std::cout << sample << std::endl;
+            float sineWave = lookup(sine, phase);
+            float sawWave = 2.0f * centred(phase);
+            float triWave = std::abs(4.0f * centred(phase) - 1.0f);
 
-    if (sample >= 1.0) {
-        sample = 1.0;
+            // 🏗️ Improved Mixing Strategy
+            float mixedWave = sineGain[k] * sineWave + sawGain[k] * sawWave + triGain[k] * triWave;
+            left[i] += mixedWave * gainLeft;
+            right[i] += mixedWave * gainRight;
+        }
     }
-    if (sample <= -1.0) {
-        sample = -1.0;
+    h.phase[0] = phase;
+}
+
+// One partial, all its unison voices at once, through the dispatched unison
+// kernel: lane v is voice v, 4 lanes for up to 4 voices and 8 for more. The
+// increments and pan gains are worked out here once per control interval;
+// the kernel does the samples in between.
+void AdditiveSynth::renderUnison(Harmonic& h, float* left, float* right, int numSamples) const {
+    using Unison = ky::Kernels::Unison;
+    static_assert(ky::Kernels::unisonTableBits == tableBits);
+    static_assert(Unison::maxLanes == maxUnison);
+
+    const auto& kernels = ky::kernels();
+    const float* sine = assets->getSine().data();
+    const int lanes = unisonVoices <= 4 ? 4 : Unison::maxLanes;
+    Unison voices;
+    for (size_t v = 0; v < maxUnison; ++v) voices.phase[v] = h.phase[v];
+
+    for (int start = 0; start < numSamples; start += controlInterval) {
+        const int count = juce::jmin(controlInterval, numSamples - start);
+        const auto k = static_cast<size_t>(start);
+        for (size_t v = 0; v < maxUnison; ++v) voices.step[v] = increment(h.step[v], pitchRatio[k]);
+        if (start == 0 || panStep != 0) {
+            const float position = panPosition(h, start);
+            for (size_t v = 0; v < maxUnison; ++v)
+                panGains(h, v, position, voices.gainLeft[v], voices.gainRight[v]);
+        }
+        kernels.unison(voices, lanes, sine, sineGain.data() + k, sawGain.data() + k,
+                       triGain.data() + k, left + start, right + start, count);
     }
 
- 
+    for (size_t v = 0; v < maxUnison; ++v) h.phase[v] = voices.phase[v];
+}
+
+void AdditiveSynth::finish(float* left, float* right, int numSamples, const float* cutoff) {
+    for (int i = 0; i < numSamples; ++i) {
+        // the filter glides to the cutoff at the end of each interval
+        if (cutoff != nullptr && i % controlInterval == 0) {
+            int length = juce::jmin(controlInterval, numSamples - i);
+            setFilterCutoff(cutoff[i + length - 1], length);
+        }
+
+        // 🎛 Apply ADSR Envelope; halved to normalize the sum
+        float envelope = 0.5f * adsr.getNextSample();
+        float frame[2] = {left[i] * envelope, right[i] * envelope};
 
-    return sample;
+        // ✅ Apply Low-Pass Filter (Ensure Smoother Sound)
+        lowPassFilter.processSample(frame, frame);
+
+        left[i] = juce::jlimit(-1.0f, 1.0f, frame[0] * 3.0f);
+        right[i] = juce::jlimit(-1.0f, 1.0f, frame[1] * 3.0f);
+    }
+}
+
+void AdditiveSynth::setUnison(int voices, float spreadCents, float width) {
+    voices = juce::jlimit(1, maxUnison, voices);
+    // called every block with the parameters as they are, so most calls change nothing
+    auto same = [](float a, float b) { return std::abs(a - b) < 1.0e-6f; };
+    if (voices == unisonVoices && same(spreadCents, unisonSpread) && same(width, unisonWidth)) return;
+    unisonVoices = voices;
+    unisonSpread = spreadCents;
+    unisonWidth = width;
+    updateVoices();
+}
+
+// Builds the per-voice tables from unisonVoices, unisonSpread and unisonWidth.
+void AdditiveSynth::updateVoices() {
+    // a lone voice stays in tune and at its partial's place, at full level,
+    // so the default sounds as it did before unison; more are scaled to keep
+    // the power of the sum about the same
+    const int voices = unisonVoices;
+    const float level = 1.0f / std::sqrt(static_cast<float>(voices));
+    for (int v = 0; v < maxUnison; ++v) {
+        auto k = static_cast<size_t>(v);
+        float position = voices > 1 ? 2.0f * static_cast<float>(v) / static_cast<float>(voices - 1) - 1.0f
+                                    : 0.0f;  // -1..1
+        voiceRatio[k] = std::exp2(position * unisonSpread / 1200.0f);
+        voiceLevel[k] = v < voices ? level : 0.0f;
+        voicePan[k] = position * unisonWidth;
+    }
+    for (auto& h : harmonics) updateIncrements(h);
 }
 
+void AdditiveSynth::setPanning(float spread, float motionHz) {
+    panSpread = juce::jlimit(0.0f, 1.0f, spread);
+    panRate = juce::jmax(0.0f, motionHz);
+    panStep = static_cast<uint32_t>(panRate * 4294967296.0 / sampleRate);
+}
 
 void AdditiveSynth::setMixingRatios(float sine, float saw, float tri) {
     sineMix = sine;
@@ -100,13 +297,14 @@ void AdditiveSynth::setMixingRatios(float sine, float saw, float tri) {
     triMix = tri;
 }
 
-void AdditiveSynth::setFilterCutoff(float cutoff) {
+void AdditiveSynth::setFilterCutoff(float cutoff, int glideSamples) {
     filterCutoff = cutoff;
-    lowPassFilter.setCutoffFrequency(filterCutoff);
+    for (int channel = 0; channel < 2; ++channel)
+        lowPassFilter.setCutoff(channel, filterCutoff, glideSamples);
 }
 
-void AdditiveSynth::setLfoDepth(float depth) {
-    lfoDepth = depth;
+void AdditiveSynth::setFilterResonance(float q, int glideSamples) {
+    filterResonance = q;
+    for (int channel = 0; channel < 2; ++channel)
+        lowPassFilter.setResonance(channel, filterResonance, glideSamples);
 }
-
-
@@ -1,47 +1,149 @@
 #pragma once
+#include <array>
 #include <vector>
 #include <cmath>
 #include <JuceHeader.h>
 
+#include "FilterBank.h"
+#include "Library.h"
+#include "RenderPool.h"
+#include "SharedAssets.h"
+
 
 
 class AdditiveSynth {
     public:
+        // Per-sample control curves for one render() call, e.g. from the mod
+        // matrix. Any left null holds the value last set.
+        struct Controls {
+            const float* sineMix = nullptr; // 0..1, clamped
+            const float* sawMix = nullptr;
+            const float* triMix = nullptr;
+            const float* pitch = nullptr;   // relative, like setPitchModulation()
+            const float* cutoff = nullptr;  // Hz
+        };
+        // pitch and cutoff follow their curves in steps of this many samples
+        static constexpr int controlInterval = 16;
+
         AdditiveSynth();
+
+        // 44.1 kHz and 512 samples until called. Renders longer than
+        // maximumBlockSize are split, so they are fine, just not split as finely.
+        void prepare(double sampleRate, int maximumBlockSize = 512);
         
         void setPentatonicChord(float baseFreq);
-        float process(float sampleRate);
+        void setChord(float baseFreq, const float* ratios, int numRatios); // One partial per ratio
+
+        // 🧵 Big chords are split into groups of partials, rendered on the
+        // shared RenderPool's workers and summed here; small ones stay inline
+        void render(float* left, float* right, int numSamples, const Controls& controls);
+        void render(float* left, float* right, int numSamples) { render(left, right, numSamples, Controls{}); }
+        void setThreadLimit(int threads) { threadLimit = juce::jmax(1, threads); } // including the caller
         void initializeADSR(); // Add this function to initialize ADSR
         void setMixingRatios(float sine, float saw, float tri);
-        void setFilterCutoff(float cutoff);
-        void setLfoDepth(float depth);
+        void setFilterCutoff(float cutoff, int glideSamples = 0); // Hz
+        void setFilterResonance(float q, int glideSamples = 0);
+        void setPitchModulation(float amount) { pitchModulation = amount; } // relative, e.g. 0.01 = +1%
+        void setSeed(uint64_t seed) { random.seed(seed); phases.seed(seed, 1); } // Detune and unison phases
+
+        // 👥 Unison: every partial is played by `voices` oscillators (up to
+        // maxUnison), detuned evenly across ±spread cents and panned across
+        // ±width (0 mono, 1 hard left to hard right). The voices of a partial
+        // run side by side in the lanes of the ky unison kernel (Dispatch.h),
+        // which holds all 8 in one AVX2 register, and one pass makes both
+        // channels, so every voice up to the register width is nearly free.
+        static constexpr int maxUnison = 8;
+        void setUnison(int voices, float spreadCents, float width);
+
+        // ↔️ Each partial also has its own place in the stereo field, spread
+        // across ±spread (0 all in the middle, 1 out to the sides), and the
+        // places can slowly orbit at motionHz (0 holds them still). A voice
+        // is panned to its partial's place plus its own unison offset, with
+        // an equal-power law, inside the render loop itself: the gains are
+        // updated once per control interval and both channels still
+        // accumulate in the one pass.
+        void setPanning(float spread, float motionHz);
+
+        int getNumHarmonics() const { return static_cast<int>(harmonics.size()); }
+        float getHarmonicFrequency(int index) const { return harmonics[static_cast<size_t>(index)].frequency; }
     
     private:
+        // 🔁 Phases are 32-bit fixed point, 2^32 to the cycle, so they wrap
+        // for free and never drift; the top bits index the wavetable. The
+        // unmodulated increment of each voice is cached and only recomputed
+        // when the frequency, unison detune or sample rate changes.
         struct Harmonic {
             float frequency;
             float amplitude;
-            float phase;
+            uint32_t pan;                          // its place on the pan orbit
+            std::array<uint32_t, maxUnison> phase; // one per unison voice
+            std::array<double, maxUnison> step;    // increment per sample, unmodulated
         };
+        static constexpr int tableBits = 12;
+
+        // below this many partial-samples a task costs more to hand out than to render
+        static constexpr int minimumTaskWork = 4096;
+
+        struct Job {
+            AdditiveSynth* synth;
+            float* left;
+            float* right;
+            int numSamples;
+            int numTasks;
+        };
+        static void renderGroup(void* job, int index);
+        static float lookup(const SharedAssets::Wavetable& sine, uint32_t phase);
+        static float centred(uint32_t phase);
+        static uint32_t increment(double step, float pitchRatio);
+        float panPosition(const Harmonic& h, int sample) const;
+        void panGains(const Harmonic& h, size_t voice, float position, float& left, float& right) const;
+        void updateIncrements(Harmonic& h) const;
+        void updateVoices();
+        void renderPartial(Harmonic& h, float* left, float* right, int numSamples) const;
+        void renderUnison(Harmonic& h, float* left, float* right, int numSamples) const;
+        void renderPartials(float* left, float* right, int numSamples);
+        void finish(float* left, float* right, int numSamples, const float* cutoff);
     
         std::vector<Harmonic> harmonics;
-    
-        float phase = 0.0f; // Global phase accumulator
+        juce::SharedResourcePointer<RenderPool> pool;
+        int threadLimit = RenderPool::maxWorkers + 1;
+
+        // preallocated in prepare(): the per-sample gains and pitch ratios
+        // every group reads, and a left and right buffer per group but the
+        // first, which renders straight into the output
+        int blockCapacity = 0;
+        std::vector<float> sineGain, sawGain, triGain, pitchRatio;
+        std::vector<std::vector<float>> groupBuffers;
+        double sampleRate = 44100.0;
+        ky::Random random;
+        ky::Random phases; // the unison voices start at random phases
+        juce::SharedResourcePointer<SharedAssets> assets; // sine table
+
+        // per unison voice: frequency ratio, level and pan offset; voices
+        // past unisonVoices are silent
+        int unisonVoices = 1;
+        float unisonSpread = 0.0f, unisonWidth = 0.0f;
+        std::array<float, maxUnison> voiceRatio{}, voiceLevel{}, voicePan{};
+
+        // the partials' pan orbit: where it is at the start of the block and
+        // how far it turns per sample, 2^32 to the turn
+        float panSpread = 0.0f, panRate = 0.0f;
+        uint32_t panPhase = 0, panStep = 0;
 
         // 🎚️ ADSR Envelope (Correct declaration)
         juce::ADSR adsr;
         juce::ADSR::Parameters adsrParams;
     
         // 🎛 Sound Texture Enhancements
-        juce::dsp::StateVariableTPTFilter<float> lowPassFilter; // Smooth filter
-        float lfoPhase = 0.0f; // For pitch modulation
-        float lfoSpeed = 0.1f; // Slow movement speed
-        float lfoDepth = 0.002f; // Subtle detuning effect
+        FilterBank lowPassFilter; // one SVF per channel, gliding between cutoffs
+        float pitchModulation = 0.0f; // From the mod matrix (vibrato and detune)
 
         float sineMix = 0.3f;
         float sawMix = 0.5f;
         float triMix = 0.2f;
 
         float filterCutoff = 2000.0f;
+        float filterResonance = 0.7f;
 };
 
 
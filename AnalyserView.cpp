@@ -0,0 +1,152 @@
+#include "AnalyserView.h"
+
+#include <algorithm>
+#include <cmath>
+
+AnalyserView::AnalyserView(AnalysisTap& dryTap, AnalysisTap& outputTap)
+    : dry{dryTap, juce::Colours::skyblue},
+      output{outputTap, juce::Colours::orange} {
+  for (auto* trace : {&dry, &output}) {
+    trace->level.fill(floorDb);
+    trace->peak.fill(floorDb);
+    trace->tap.setActive(true);
+  }
+  setOpaque(true);
+}
+
+AnalyserView::~AnalyserView() {
+  dry.tap.setActive(false);
+  output.tap.setActive(false);
+}
+
+bool AnalyserView::pull(Trace& trace) {
+  int total = 0;
+  for (int n; (n = trace.tap.pull(incoming.data() + total,
+                                  static_cast<int>(incoming.size()) - total)) > 0;)
+    total += n;
+  if (total == 0) return false;
+
+  // keep the most recent fftSize samples
+  auto& h = trace.history;
+  if (total >= fftSize) {
+    std::copy_n(incoming.data() + total - fftSize, fftSize, h.data());
+  } else {
+    std::move(h.begin() + total, h.end(), h.begin());
+    std::copy_n(incoming.data(), total, h.end() - total);
+  }
+  return true;
+}
+
+void AnalyserView::analyse(Trace& trace) {
+  std::copy(trace.history.begin(), trace.history.end(), fftData.begin());
+  std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+  window.multiplyWithWindowingTable(fftData.data(), static_cast<size_t>(fftSize));
+  fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+  // a full-scale sine reads 0 dB through a Hann window
+  const float scale = 4.0f / fftSize;
+  const double sampleRate = trace.tap.getSampleRate();
+  const double binHz = sampleRate / fftSize;
+  const float peakFall = 1.5f;  // dB per update
+
+  for (int b = 0; b < numBins; ++b) {
+    double lo = 20.0 * std::pow(1000.0, b / static_cast<double>(numBins));
+    double hi = 20.0 * std::pow(1000.0, (b + 1) / static_cast<double>(numBins));
+    int first = juce::jlimit(1, fftSize / 2 - 1, static_cast<int>(lo / binHz));
+    int last = juce::jlimit(first, fftSize / 2 - 1, static_cast<int>(hi / binHz));
+
+    float magnitude = 0;
+    for (int k = first; k <= last; ++k) magnitude = std::max(magnitude, fftData[static_cast<size_t>(k)]);
+
+    float db = juce::jmax(floorDb, juce::Decibels::gainToDecibels(magnitude * scale, floorDb));
+    trace.level[static_cast<size_t>(b)] = db;
+    trace.peak[static_cast<size_t>(b)] =
+        juce::jmax(db, trace.peak[static_cast<size_t>(b)] - peakFall);
+  }
+}
+
+juce::Path AnalyserView::spectrumPath(const std::array<float, numBins>& levels) const {
+  juce::Path path;
+  for (int b = 0; b < numBins; ++b) {
+    float x = spectrumArea.getX() + spectrumArea.getWidth() * (b + 0.5f) / numBins;
+    float y = juce::jmap(levels[static_cast<size_t>(b)], floorDb, 0.0f,
+                         spectrumArea.getBottom(), spectrumArea.getY());
+    if (b == 0)
+      path.startNewSubPath(x, y);
+    else
+      path.lineTo(x, y);
+  }
+  return path;
+}
+
+juce::Path AnalyserView::scopePath() const {
+  juce::Path path;
+  const auto& h = output.history;
+  const float mid = scopeArea.getCentreY();
+  const float halfHeight = scopeArea.getHeight() * 0.5f;
+  for (int i = 0; i < scopeSize; ++i) {
+    float sample = juce::jlimit(-1.0f, 1.0f, h[static_cast<size_t>(fftSize - scopeSize + i)]);
+    float x = scopeArea.getX() + scopeArea.getWidth() * i / (scopeSize - 1);
+    float y = mid - sample * halfHeight;
+    if (i == 0)
+      path.startNewSubPath(x, y);
+    else
+      path.lineTo(x, y);
+  }
+  return path;
+}
+
+// swap in a new path and repaint only where the old or new one is drawn
+void AnalyserView::replace(juce::Path& path, juce::Path next) {
+  auto dirty = path.getBounds().getUnion(next.getBounds()).expanded(2.0f);
+  path = std::move(next);
+  repaint(dirty.getSmallestIntegerContainer());
+}
+
+void AnalyserView::update() {
+  if (spectrumArea.isEmpty()) return;
+
+  for (auto* trace : {&dry, &output}) {
+    if (!pull(*trace)) continue;  // nothing new: leave the trace as it is
+    analyse(*trace);
+    replace(trace->spectrum, spectrumPath(trace->level));
+    if (trace == &output) {
+      replace(trace->peaks, spectrumPath(trace->peak));
+      replace(scope, scopePath());
+    }
+  }
+}
+
+void AnalyserView::paint(juce::Graphics& g) {
+  g.fillAll(juce::Colours::black);
+
+  g.setColour(juce::Colours::white.withAlpha(0.15f));
+  for (float db = -24; db > floorDb; db -= 24) {
+    float y = juce::jmap(db, floorDb, 0.0f, spectrumArea.getBottom(), spectrumArea.getY());
+    g.drawHorizontalLine(juce::roundToInt(y), spectrumArea.getX(), spectrumArea.getRight());
+  }
+  g.drawHorizontalLine(juce::roundToInt(scopeArea.getCentreY()), scopeArea.getX(),
+                       scopeArea.getRight());
+
+  g.setColour(dry.colour);
+  g.strokePath(dry.spectrum, juce::PathStrokeType(1.5f));
+  g.setColour(output.colour.withAlpha(0.5f));
+  g.strokePath(output.peaks, juce::PathStrokeType(1.0f));
+  g.setColour(output.colour);
+  g.strokePath(output.spectrum, juce::PathStrokeType(1.5f));
+  g.strokePath(scope, juce::PathStrokeType(1.0f));
+}
+
+void AnalyserView::resized() {
+  auto area = getLocalBounds().toFloat().reduced(4.0f);
+  spectrumArea = area.removeFromTop(area.getHeight() * 0.65f);
+  area.removeFromTop(4.0f);
+  scopeArea = area;
+
+  // the geometry changed, so rebuild every path and repaint everything
+  dry.spectrum = spectrumPath(dry.level);
+  output.spectrum = spectrumPath(output.level);
+  output.peaks = spectrumPath(output.peak);
+  scope = scopePath();
+  repaint();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <vector>
+
+#include "AnalysisTap.h"
+
+// Spectrum of the dry signal (before the reverb) and of the output, with peak
+// hold, over a scope of the output. Everything here runs on the message thread:
+// update() is called from the editor's timer, drains both taps, runs the FFTs,
+// and repaints only the area the changed traces cover. The taps are switched on while the view
+// exists, so a closed editor costs the audio thread nothing.
+class AnalyserView : public juce::Component {
+ public:
+  AnalyserView(AnalysisTap& dry, AnalysisTap& output);
+  ~AnalyserView() override;
+
+  void update();
+
+  void paint(juce::Graphics&) override;
+  void resized() override;
+
+ private:
+  static constexpr int fftOrder = 11;
+  static constexpr int fftSize = 1 << fftOrder;
+  static constexpr int numBins = 96;  // log-spaced, 20 Hz to 20 kHz
+  static constexpr int scopeSize = 512;
+  static constexpr float floorDb = -96.0f;
+
+  struct Trace {
+    AnalysisTap& tap;
+    juce::Colour colour;
+    std::vector<float> history = std::vector<float>(fftSize, 0.0f);
+    std::array<float, numBins> level{};
+    std::array<float, numBins> peak{};
+    juce::Path spectrum, peaks;
+  };
+
+  // pull new audio into the trace's history; false if nothing arrived
+  bool pull(Trace& trace);
+  void analyse(Trace& trace);
+  juce::Path spectrumPath(const std::array<float, numBins>& levels) const;
+  juce::Path scopePath() const;
+  void replace(juce::Path& path, juce::Path next);
+
+  Trace dry, output;
+  juce::Path scope;
+  juce::Rectangle<float> spectrumArea, scopeArea;
+
+  juce::dsp::FFT fft{fftOrder};
+  juce::dsp::WindowingFunction<float> window{
+      static_cast<size_t>(fftSize), juce::dsp::WindowingFunction<float>::hann};
+  std::vector<float> fftData = std::vector<float>(2 * fftSize, 0.0f);
+  std::vector<float> incoming = std::vector<float>(AnalysisTap::capacity, 0.0f);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyserView)
+};
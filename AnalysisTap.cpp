@@ -0,0 +1,50 @@
+#include "AnalysisTap.h"
+
+void AnalysisTap::setActive(bool shouldBeActive) {
+  if (shouldBeActive && !isActive()) {
+    // throw away anything left over from the last time a view was open
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+    fifo.finishedRead(size1 + size2);
+  }
+  active.store(shouldBeActive, std::memory_order_relaxed);
+}
+
+void AnalysisTap::push(const juce::AudioBuffer<float>& buffer, int startSample,
+                       int numSamples) {
+  if (!isActive()) return;
+
+  int channels = juce::jmin(maxChannels, buffer.getNumChannels());
+  numChannels.store(channels, std::memory_order_relaxed);
+
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+  for (int channel = 0; channel < channels; ++channel) {
+    if (size1 > 0) ring.copyFrom(channel, start1, buffer, channel, startSample, size1);
+    if (size2 > 0)
+      ring.copyFrom(channel, start2, buffer, channel, startSample + size1, size2);
+  }
+  fifo.finishedWrite(size1 + size2);
+}
+
+int AnalysisTap::pull(float* destination, int maxSamples) {
+  int channels = numChannels.load(std::memory_order_relaxed);
+  float gain = 1.0f / static_cast<float>(channels);
+
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+
+  auto mix = [&](int start, int size, float* out) {
+    for (int i = 0; i < size; ++i) {
+      float sum = 0;
+      for (int channel = 0; channel < channels; ++channel)
+        sum += ring.getSample(channel, start + i);
+      out[i] = sum * gain;
+    }
+  };
+  mix(start1, size1, destination);
+  mix(start2, size2, destination + size1);
+
+  fifo.finishedRead(size1 + size2);
+  return size1 + size2;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+// A point in processBlock whose audio can be watched from the message thread.
+// The audio thread copies each block into a wait-free SPSC ring (a memcpy per
+// channel), and only while a view has the tap switched on; otherwise push()
+// returns straight away. If the reader falls behind, new audio is dropped
+// rather than blocking.
+class AnalysisTap {
+ public:
+  static constexpr int capacity = 1 << 15;
+  static constexpr int maxChannels = 2;
+
+  void prepare(double sampleRate) { samplerate = sampleRate; }
+  double getSampleRate() const { return samplerate; }
+
+  // message thread: a view turns the tap on while it is showing
+  void setActive(bool shouldBeActive);
+  bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+  // audio thread
+  void push(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+  // message thread: read up to maxSamples, summed to mono. Returns how many
+  int pull(float* destination, int maxSamples);
+
+ private:
+  std::atomic<bool> active{false};
+  std::atomic<double> samplerate{44100};
+  juce::AbstractFifo fifo{capacity};
+  juce::AudioBuffer<float> ring{maxChannels, capacity};
+  std::atomic<int> numChannels{1};
+};
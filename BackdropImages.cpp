@@ -0,0 +1,37 @@
+#include "BackdropImages.h"
+
+BackdropImages::BackdropImages() : juce::Thread("Backdrop Images") {
+  startThread();
+}
+
+BackdropImages::~BackdropImages() { stopThread(5000); }
+
+juce::Image BackdropImages::get(int irChoice) const {
+  if (irChoice < 0 || irChoice >= static_cast<int>(images.size())) return {};
+  const juce::ScopedLock sl(lock);
+  return images[static_cast<size_t>(irChoice)];
+}
+
+void BackdropImages::run() {
+  auto desktop = juce::File::getSpecialLocation(juce::File::userDesktopDirectory);
+  const char* names[] = {"church.png", "cave.png", "room.png"};
+
+  for (size_t i = 0; i < images.size() && !threadShouldExit(); ++i) {
+    auto image = juce::ImageFileFormat::loadFrom(desktop.getChildFile(names[i]));
+    if (!image.isValid()) continue;
+
+    // scale once to fit the display, so painting never resamples the original
+    auto bounds = juce::RectanglePlacement(juce::RectanglePlacement::centred)
+                      .appliedTo(image.getBounds().toFloat(),
+                                 juce::Rectangle<float>(0, 0, width, height));
+    image = image.rescaled(juce::jmax(1, juce::roundToInt(bounds.getWidth())),
+                           juce::jmax(1, juce::roundToInt(bounds.getHeight())),
+                           juce::Graphics::highResamplingQuality);
+
+    {
+      const juce::ScopedLock sl(lock);
+      images[i] = image;
+    }
+    sendChangeMessage();
+  }
+}
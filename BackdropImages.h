@@ -0,0 +1,29 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+
+// The pictures shown for each IR choice. They are decoded on a background
+// thread and scaled once to the editor's display area, then shared by every
+// open editor through juce::SharedResourcePointer<BackdropImages>. Listeners
+// are told (on the message thread) when the images become available.
+class BackdropImages : public juce::ChangeBroadcaster, private juce::Thread {
+ public:
+  static constexpr int width = 660;
+  static constexpr int height = 260;
+
+  BackdropImages();
+  ~BackdropImages() override;
+
+  // an invalid image until that picture has been decoded
+  juce::Image get(int irChoice) const;
+
+ private:
+  void run() override;
+
+  juce::CriticalSection lock;
+  std::array<juce::Image, 3> images;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackdropImages)
+};
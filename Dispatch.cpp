@@ -0,0 +1,309 @@
+#include "Dispatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KY_DISPATCH_X86 1
+#define KY_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#else
+#define KY_DISPATCH_X86 0
+#endif
+
+#if defined(_MSC_VER)
+#define KY_INLINE __forceinline
+#else
+#define KY_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace ky {
+
+namespace {
+
+// The kernels, written once. Each is inlined into one function per instruction
+// set below, and vectorized there for that set. Sums keep one accumulator per
+// lane, so they vectorize without reassociating.
+namespace body {
+
+constexpr int philoxLanes = Kernels::philoxLanes;
+constexpr int sumLanes = 16;  // one AVX-512 register of floats
+constexpr int dotLanes = 8;   // one AVX2 register of floats
+
+KY_INLINE void philox(uint64_t counter, uint32_t stream, const uint32_t key[2],
+                      uint32_t* block) {
+  uint32_t x0[philoxLanes], x1[philoxLanes], x2[philoxLanes], x3[philoxLanes];
+  for (int l = 0; l < philoxLanes; ++l) {
+    uint64_t c = counter + static_cast<uint64_t>(l);
+    x0[l] = static_cast<uint32_t>(c);
+    x1[l] = static_cast<uint32_t>(c >> 32);
+    x2[l] = stream;
+    x3[l] = 0;
+  }
+
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < 10; ++round) {
+    for (int l = 0; l < philoxLanes; ++l) {
+      uint64_t p0 = 0xD2511F53ull * x0[l];
+      uint64_t p1 = 0xCD9E8D57ull * x2[l];
+      uint32_t y0 = static_cast<uint32_t>(p1 >> 32) ^ x1[l] ^ k0;
+      uint32_t y2 = static_cast<uint32_t>(p0 >> 32) ^ x3[l] ^ k1;
+      x1[l] = static_cast<uint32_t>(p1);
+      x3[l] = static_cast<uint32_t>(p0);
+      x0[l] = y0;
+      x2[l] = y2;
+    }
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+
+  for (int l = 0; l < philoxLanes; ++l) {
+    block[4 * l + 0] = x0[l];
+    block[4 * l + 1] = x1[l];
+    block[4 * l + 2] = x2[l];
+    block[4 * l + 3] = x3[l];
+  }
+}
+
+KY_INLINE double energy(const float* x, int n) {
+  double lane[sumLanes] = {};
+  int i = 0;
+  for (; i + sumLanes <= n; i += sumLanes)
+    for (int l = 0; l < sumLanes; ++l)
+      lane[l] += static_cast<double>(x[i + l]) * x[i + l];
+  double sum = 0;
+  for (; i < n; ++i) sum += static_cast<double>(x[i]) * x[i];
+  for (double s : lane) sum += s;
+  return sum;
+}
+
+KY_INLINE void crossfade(const float* dry, float* wet, float mix, float step, int n) {
+  for (int i = 0; i < n; ++i) {
+    float m = mix + step * static_cast<float>(i);
+    wet[i] = (1.0f - m) * dry[i] + m * wet[i];
+  }
+}
+
+// One inner product per output, with the row for its phase interpolated
+// linearly towards the next. The taps are a constant here, so the lanes are
+// whole registers and the sum is a fixed tree.
+template <size_t taps>
+KY_INLINE void polyphase(const float* input, const float* table, uint64_t position,
+                         uint64_t increment, float* output, int n) {
+  constexpr int fractionBits = 32 - Kernels::polyphaseBits;
+  constexpr float fractionScale = 1.0f / static_cast<float>(1u << fractionBits);
+  constexpr size_t lanes = std::min(taps, static_cast<size_t>(dotLanes));
+  for (int i = 0; i < n; ++i, position += increment) {
+    const float* x = input + (position >> 32);
+    auto phase = static_cast<uint32_t>(position);
+    const float* row = table + 2 * taps * (phase >> fractionBits);
+    float f = static_cast<float>(phase & ((1u << fractionBits) - 1)) * fractionScale;
+
+    float lane[lanes] = {};
+    for (size_t t = 0; t < taps; t += lanes)
+      for (size_t l = 0; l < lanes; ++l) lane[l] += x[t + l] * (row[t + l] + f * row[taps + t + l]);
+    for (size_t width = lanes / 2; width > 0; width /= 2)
+      for (size_t l = 0; l < width; ++l) lane[l] += lane[l + width];
+    output[i] = lane[0];
+  }
+}
+
+KY_INLINE void polyphase(const float* input, const float* table, int taps, uint64_t position,
+                         uint64_t increment, float* output, int n) {
+  switch (taps) {
+    case 4:
+      return polyphase<4>(input, table, position, increment, output, n);
+    case 8:
+      return polyphase<8>(input, table, position, increment, output, n);
+    case 16:
+      return polyphase<16>(input, table, position, increment, output, n);
+    default:
+      return polyphase<32>(input, table, position, increment, output, n);
+  }
+}
+
+// table[index[v]] for every lane; the AVX2 and AVX-512 kernels read eight
+// in one instruction, which the compiler won't use by itself
+#if KY_DISPATCH_X86
+KY_TARGET("avx2") inline void gather8(const float* table, const int32_t* index, float* out) {
+  __m256i i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index));
+  _mm256_storeu_ps(out, _mm256_i32gather_ps(table, i, 4));
+}
+#endif
+
+template <Isa isa, size_t lanes>
+KY_INLINE void gather(const float* table, const int32_t* index, float* out) {
+#if KY_DISPATCH_X86
+  if constexpr (isa != Isa::generic && lanes == 8)
+    gather8(table, index, out);
+  else
+#endif
+    for (size_t v = 0; v < lanes; ++v) out[v] = table[index[v]];
+}
+
+// Lane by lane in separate passes, so each one vectorizes: the phases, the
+// table reads, the mix, then the lanes summed into each channel by a fixed
+// tree, once per sample
+template <Isa isa, size_t lanes>
+KY_INLINE void unison(Kernels::Unison& voices, const float* sine, const float* sineGain,
+                      const float* sawGain, const float* triGain, float* left, float* right,
+                      int n) {
+  constexpr int fractionBits = 32 - Kernels::unisonTableBits;
+  constexpr uint32_t fractionMask = (1u << fractionBits) - 1;
+  constexpr float fractionScale = 1.0f / static_cast<float>(1u << fractionBits);
+
+  // local copies: the stores to left and right could alias `voices`
+  uint32_t phase[lanes], step[lanes];
+  float gainLeft[lanes], gainRight[lanes];
+  for (size_t v = 0; v < lanes; ++v) {
+    phase[v] = voices.phase[v];
+    step[v] = voices.step[v];
+    gainLeft[v] = voices.gainLeft[v];
+    gainRight[v] = voices.gainRight[v];
+  }
+
+  for (int i = 0; i < n; ++i) {
+    int32_t index[lanes];
+    float fraction[lanes], centred[lanes], below[lanes], above[lanes];
+    for (size_t v = 0; v < lanes; ++v) {
+      phase[v] += step[v];  // wraps by itself
+      index[v] = static_cast<int32_t>(phase[v] >> fractionBits);
+      fraction[v] =
+          static_cast<float>(static_cast<int32_t>(phase[v] & fractionMask)) * fractionScale;
+      centred[v] = static_cast<float>(static_cast<int32_t>(phase[v])) * 0x1p-32f;  // -0.5..0.5
+    }
+    gather<isa, lanes>(sine, index, below);
+    gather<isa, lanes>(sine + 1, index, above);
+
+    float laneLeft[lanes], laneRight[lanes];
+    for (size_t v = 0; v < lanes; ++v) {
+      float s = below[v] + fraction[v] * (above[v] - below[v]);
+      float c = centred[v];
+      float mixed = s * sineGain[i] + c * (2.0f * sawGain[i]) +
+                    std::abs(c * 4.0f - 1.0f) * triGain[i];
+      laneLeft[v] = mixed * gainLeft[v];
+      laneRight[v] = mixed * gainRight[v];
+    }
+    for (size_t width = lanes / 2; width > 0; width /= 2)
+      for (size_t v = 0; v < width; ++v) {
+        laneLeft[v] += laneLeft[v + width];
+        laneRight[v] += laneRight[v + width];
+      }
+    left[i] += laneLeft[0];
+    right[i] += laneRight[0];
+  }
+
+  for (size_t v = 0; v < lanes; ++v) voices.phase[v] = phase[v];
+}
+
+template <Isa isa>
+KY_INLINE void unison(Kernels::Unison& voices, int lanes, const float* sine,
+                      const float* sineGain, const float* sawGain, const float* triGain,
+                      float* left, float* right, int n) {
+  if (lanes <= 4)
+    unison<isa, 4>(voices, sine, sineGain, sawGain, triGain, left, right, n);
+  else
+    unison<isa, Kernels::Unison::maxLanes>(voices, sine, sineGain, sawGain, triGain, left,
+                                           right, n);
+}
+
+}  // namespace body
+
+// one set of kernels per instruction set; the target attribute is all that
+// differs, apart from the gathers in the unison kernel
+#define KY_KERNELS(prefix, attributes)                                               \
+  attributes void prefix##Philox(uint64_t counter, uint32_t stream,                \
+                                 const uint32_t key[2], uint32_t* block) {         \
+    body::philox(counter, stream, key, block);                                     \
+  }                                                                                \
+  attributes double prefix##Energy(const float* x, int n) { return body::energy(x, n); } \
+  attributes void prefix##Crossfade(const float* dry, float* wet, float mix, float step, \
+                                    int n) {                                       \
+    body::crossfade(dry, wet, mix, step, n);                                       \
+  }                                                                                \
+  attributes void prefix##Polyphase(const float* input, const float* table, int taps, \
+                                    uint64_t position, uint64_t increment, float* output, \
+                                    int n) {                                       \
+    body::polyphase(input, table, taps, position, increment, output, n);           \
+  }                                                                                \
+  attributes void prefix##Unison(Kernels::Unison& voices, int lanes, const float* sine, \
+                                 const float* sineGain, const float* sawGain,      \
+                                 const float* triGain, float* left, float* right, int n) { \
+    body::unison<Isa::prefix>(voices, lanes, sine, sineGain, sawGain, triGain, left, \
+                              right, n);                                           \
+  }                                                                                \
+  constexpr Kernels prefix##Kernels{prefix##Philox, prefix##Energy, prefix##Crossfade, \
+                                    prefix##Polyphase, prefix##Unison};
+
+KY_KERNELS(generic, )
+#if KY_DISPATCH_X86
+KY_KERNELS(avx2, KY_TARGET("avx2,fma"))
+KY_KERNELS(avx512, KY_TARGET("avx512f,avx512vl,avx2,fma"))
+#endif
+
+const Kernels& kernelsFor(Isa isa) {
+#if KY_DISPATCH_X86
+  if (isa == Isa::avx512) return avx512Kernels;
+  if (isa == Isa::avx2) return avx2Kernels;
+#endif
+  return genericKernels;
+}
+
+Isa parseIsa(const char* name, Isa fallback) {
+  for (auto isa : {Isa::generic, Isa::avx2, Isa::avx512})
+    if (std::strcmp(name, getIsaName(isa)) == 0) return isa;
+  return fallback;
+}
+
+Isa clamp(Isa isa) {
+  Isa widest = detectIsa();
+  return static_cast<int>(isa) < static_cast<int>(widest) ? isa : widest;
+}
+
+// chosen on first use, from KY_ISA if it is set
+std::atomic<Isa>& selected() {
+  static std::atomic<Isa> isa{[] {
+    const char* name = std::getenv("KY_ISA");
+    return name != nullptr ? clamp(parseIsa(name, detectIsa())) : detectIsa();
+  }()};
+  return isa;
+}
+
+}  // namespace
+
+const char* getIsaName(Isa isa) {
+  switch (isa) {
+    case Isa::generic:
+      break;
+    case Isa::avx2:
+      return "avx2";
+    case Isa::avx512:
+      return "avx512";
+  }
+  return "generic";
+}
+
+Isa detectIsa() {
+#if KY_DISPATCH_X86
+  // these check the OS saves the wider registers, too
+  __builtin_cpu_init();
+  bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  if (avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl"))
+    return Isa::avx512;
+  if (avx2) return Isa::avx2;
+#endif
+  return Isa::generic;
+}
+
+Isa getIsa() { return selected().load(std::memory_order_relaxed); }
+
+void setIsa(Isa isa) { selected().store(clamp(isa), std::memory_order_relaxed); }
+
+const Kernels& kernels() { return kernelsFor(getIsa()); }
+
+}  // namespace ky
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ky {
+
+// Runtime CPU dispatch for the kernels that gain from wider vectors. The plugin
+// is built for the baseline (SSE2 on x86-64), so each kernel is also compiled
+// for AVX2 and AVX-512 and the widest one the CPU supports is chosen once, by
+// CPUID, the first time kernels() is called. A kernel call is then one load of
+// a function pointer.
+//
+// The variants are built from the same plain loops over lanes and differ only
+// in the code the compiler generates (the wider ones may fuse multiply-adds, so
+// float results can differ in the last bit); only the unison kernel's table
+// reads are written out, as AVX2 gathers in both wider ones. Only x86-64 with GCC
+// or Clang gets the wider variants; elsewhere every kernel is the generic one.
+//
+// For testing, setIsa() or the KY_ISA environment variable ("generic", "avx2"
+// or "avx512") pins the variants, down to what the CPU supports.
+enum class Isa { generic, avx2, avx512 };
+
+const char* getIsaName(Isa isa);
+Isa detectIsa();  // the widest the CPU and OS support
+Isa getIsa();     // the one kernels() uses
+void setIsa(Isa isa);
+
+struct Kernels {
+  // Philox4x32-10 (see Random): 4 * philoxLanes words, for the counters
+  // counter .. counter + philoxLanes - 1
+  static constexpr int philoxLanes = 8;
+  void (*philox)(uint64_t counter, uint32_t stream, const uint32_t key[2], uint32_t* block);
+
+  // sum of the squares, in double
+  double (*energy)(const float* x, int n);
+
+  // wet[i] = (1 - m) * dry[i] + m * wet[i], with m = mix + step * i
+  void (*crossfade)(const float* dry, float* wet, float mix, float step, int n);
+
+  // output[i]: input at position + i * increment (32.32 fixed point, in
+  // samples from input[0]) through a polyphase table of 4, 8, 16 or 32 taps
+  // (see Resampler). A row of the table is `taps` coefficients and then their
+  // differences to the next row; there are 1 << polyphaseBits rows.
+  static constexpr int polyphaseBits = 8;
+  void (*polyphase)(const float* input, const float* table, int taps, uint64_t position,
+                    uint64_t increment, float* output, int n);
+
+  // The unison voices of one partial (see AdditiveSynth), lane v being voice
+  // v: each phase (2^32 to the cycle) advances by its step every sample, and
+  // the sine (from a table of 2^unisonTableBits entries and a guard), saw
+  // and triangle of it, mixed by the per-sample gains, go into both channels
+  // with the lane's gains. `lanes` is 4 or 8; AVX2 holds all 8 in a register.
+  static constexpr int unisonTableBits = 12;
+  struct Unison {
+    static constexpr int maxLanes = 8;
+    uint32_t phase[maxLanes];
+    uint32_t step[maxLanes];
+    float gainLeft[maxLanes];
+    float gainRight[maxLanes];
+  };
+  void (*unison)(Unison& voices, int lanes, const float* sine, const float* sineGain,
+                 const float* sawGain, const float* triGain, float* left, float* right, int n);
+};
+
+const Kernels& kernels();
+
+}  // namespace ky
@@ -0,0 +1,109 @@
+#include "FilterBank.h"
+
+#include <algorithm>
+
+void FilterBank::prepare(double sampleRate, int filters) {
+  samplerate = sampleRate;
+  numFilters = filters;
+  frame.assign(static_cast<size_t>(filters), 0.0f);
+  groups.assign(static_cast<size_t>((filters + lanes - 1) / lanes), Group{});
+  for (auto& group : groups) {
+    group.cutoff.fill(1000.0f);
+    group.resonance.fill(0.70710678f);
+    retarget(group, 0);
+  }
+  reset();
+}
+
+void FilterBank::reset() {
+  for (auto& group : groups) {
+    group.ic1 = Register::expand(0.0f);
+    group.ic2 = Register::expand(0.0f);
+  }
+}
+
+void FilterBank::setCutoff(int filter, float hertz, int samples) {
+  if (filter < 0 || filter >= numFilters) return;
+  auto& group = groups[static_cast<size_t>(filter / lanes)];
+  group.cutoff[static_cast<size_t>(filter % lanes)] = hertz;
+  retarget(group, samples);
+}
+
+void FilterBank::setResonance(int filter, float q, int samples) {
+  if (filter < 0 || filter >= numFilters) return;
+  auto& group = groups[static_cast<size_t>(filter / lanes)];
+  group.resonance[static_cast<size_t>(filter % lanes)] = q;
+  retarget(group, samples);
+}
+
+void FilterBank::retarget(Group& group, int samples) {
+  alignas(Register::SIMDRegisterSize) std::array<float, lanes> c1, c2, c3;
+  const float nyquistLimit = 0.49f * static_cast<float>(samplerate);
+  for (size_t l = 0; l < static_cast<size_t>(lanes); ++l) {
+    float hertz = std::clamp(group.cutoff[l], 10.0f, nyquistLimit);
+    float g = fastTan(juce::MathConstants<float>::pi * hertz / static_cast<float>(samplerate));
+    float k = 1.0f / std::max(group.resonance[l], 0.05f);
+    c1[l] = 1.0f / (1.0f + g * (g + k));
+    c2[l] = g * c1[l];
+    c3[l] = g * c2[l];
+  }
+  group.t1 = Register::fromRawArray(c1.data());
+  group.t2 = Register::fromRawArray(c2.data());
+  group.t3 = Register::fromRawArray(c3.data());
+
+  if (samples <= 0) {
+    group.a1 = group.t1;
+    group.a2 = group.t2;
+    group.a3 = group.t3;
+    group.d1 = group.d2 = group.d3 = Register::expand(0.0f);
+    group.glide = 0;
+    return;
+  }
+  float scale = 1.0f / static_cast<float>(samples);
+  group.d1 = (group.t1 - group.a1) * scale;
+  group.d2 = (group.t2 - group.a2) * scale;
+  group.d3 = (group.t3 - group.a3) * scale;
+  group.glide = samples;
+}
+
+void FilterBank::processSample(const float* input, float* output) {
+  alignas(Register::SIMDRegisterSize) std::array<float, lanes> lane{};
+
+  for (size_t g = 0; g < groups.size(); ++g) {
+    auto& group = groups[g];
+    int first = static_cast<int>(g) * lanes;
+    int count = std::min(lanes, numFilters - first);
+
+    std::copy_n(input + first, count, lane.data());
+    Register v0 = Register::fromRawArray(lane.data());
+
+    if (group.glide > 0) {
+      if (--group.glide == 0) {
+        group.a1 = group.t1;
+        group.a2 = group.t2;
+        group.a3 = group.t3;
+      } else {
+        group.a1 += group.d1;
+        group.a2 += group.d2;
+        group.a3 += group.d3;
+      }
+    }
+
+    Register v3 = v0 - group.ic2;
+    Register v1 = group.a1 * group.ic1 + group.a2 * v3;
+    Register v2 = group.ic2 + group.a2 * group.ic1 + group.a3 * v3;
+    group.ic1 = v1 * 2.0f - group.ic1;
+    group.ic2 = v2 * 2.0f - group.ic2;
+
+    v2.copyToRawArray(lane.data());
+    std::copy_n(lane.data(), count, output + first);
+  }
+}
+
+void FilterBank::process(float* const* channels, int numSamples) {
+  for (int i = 0; i < numSamples; ++i) {
+    for (int f = 0; f < numFilters; ++f) frame[static_cast<size_t>(f)] = channels[f][i];
+    processSample(frame.data(), frame.data());
+    for (int f = 0; f < numFilters; ++f) channels[f][i] = frame[static_cast<size_t>(f)];
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <vector>
+
+// Many independent state-variable lowpass filters (the trapezoidal SVF of
+// Zavalishin / Simper), run side by side in the lanes of a SIMD register: one
+// per channel, voice or partial group. Filters are grouped `lanes` at a
+// time, so one filter costs about as much as `lanes` of them.
+//
+// A new cutoff or resonance doesn't step: the coefficients glide there in a
+// straight line over the number of samples given, recomputed per sample. The
+// tan() prewarp is a rational approximation, only evaluated when a target
+// changes.
+class FilterBank {
+ public:
+  using Register = juce::dsp::SIMDRegister<float>;
+  static constexpr int lanes = static_cast<int>(Register::size());
+
+  // allocates; every filter starts at 1 kHz, Q 0.707, with no history
+  void prepare(double sampleRate, int numFilters);
+  void reset();
+  int getNumFilters() const { return numFilters; }
+
+  // glide to a new cutoff (Hz) / resonance (Q; 0.707 is flattest) over
+  // `samples` samples; 0 jumps
+  void setCutoff(int filter, float hertz, int samples);
+  void setResonance(int filter, float q, int samples);
+
+  // one sample for every filter: input[f] in, output[f] out
+  void processSample(const float* input, float* output);
+
+  // in place, channel f through filter f
+  void process(float* const* channels, int numSamples);
+
+  // tan(x) for x in [0, pi/2): a [5/4] Pade approximant, within 0.05% up to
+  // 0.49 pi
+  static constexpr float fastTan(float x) {
+    float x2 = x * x;
+    return x * (945 - 105 * x2 + x2 * x2) / (945 - 420 * x2 + 15 * x2 * x2);
+  }
+
+ private:
+  struct Group {
+    Register a1, a2, a3;  // coefficients now
+    Register d1, d2, d3;  // added per sample while gliding
+    Register t1, t2, t3;  // where the glide ends
+    Register ic1, ic2;    // integrator states
+    int glide = 0;        // samples left in the glide
+    alignas(Register::SIMDRegisterSize) std::array<float, lanes> cutoff{};
+    alignas(Register::SIMDRegisterSize) std::array<float, lanes> resonance{};
+  };
+
+  void retarget(Group& group, int samples);
+
+  double samplerate = 44100;
+  int numFilters = 0;
+  std::vector<Group> groups;
+  std::vector<float> frame;  // one sample of every channel, for process()
+};
@@ -18,15 +18,168 @@ PlaybackRateObserver::PlaybackRateObserver() {
   PlaybackRateSubject::instance().addObserver(this);
 }
 
-void PlaybackRateSubject::notifyObservers(float samplerate) {
+// A copy is a new observer too, so it joins the list as well
+PlaybackRateObserver::PlaybackRateObserver(PlaybackRateObserver const&) {
+  PlaybackRateSubject::instance().addObserver(this);
+}
+
+// Assignment keeps this observer's rate and its place in the list
+PlaybackRateObserver& PlaybackRateObserver::operator=(
+    PlaybackRateObserver const&) {
+  return *this;
+}
+
+// ...and when it dies, it leaves, so the list never holds a dangling pointer
+PlaybackRateObserver::~PlaybackRateObserver() {
+  PlaybackRateSubject::instance().removeObserver(this);
+}
+
+void PlaybackRateSubject::notifyObservers(float rate) {
+  std::lock_guard<std::mutex> lock(mutex);
+  samplerate = rate;
   for (auto* o = list; o != nullptr; o = o->nextObserver) {
-    o->onPlaybackRateChange(samplerate);
+    o->onPlaybackRateChange(rate);
   }
 }
 
 void PlaybackRateSubject::addObserver(PlaybackRateObserver* observer) {
+  std::lock_guard<std::mutex> lock(mutex);
+  observer->samplerate = samplerate;
   observer->nextObserver = list;
   list = observer;
 }
 
+void PlaybackRateSubject::removeObserver(PlaybackRateObserver* observer) {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto** link = &list; *link != nullptr; link = &(*link)->nextObserver) {
+    if (*link == observer) {
+      *link = observer->nextObserver;
+      return;
+    }
+  }
+}
+
+namespace {
+
+// Kaiser window shape per tap count, and the cutoff (of the input's Nyquist,
+// at increment 1): longer filters can afford a sharper, higher edge
+struct ResamplerDesign {
+  int taps;
+  double beta;
+  double cutoff;
+};
+constexpr ResamplerDesign resamplerDesigns[] = {
+    {4, 4.0, 0.70}, {8, 6.0, 0.80}, {16, 8.0, 0.88}, {32, 9.5, 0.92}};
+constexpr int numResamplerDesigns = 4;
+
+int designIndex(int taps) {
+  for (int d = 0; d < numResamplerDesigns; ++d)
+    if (taps <= resamplerDesigns[d].taps) return d;
+  return numResamplerDesigns - 1;
+}
+
+// the zeroth-order modified Bessel function, by its series
+double besselI0(double x) {
+  double sum = 1, term = 1;
+  for (int k = 1; k < 50 && term > sum * 1e-12; ++k) {
+    term *= (x / (2 * k)) * (x / (2 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+// Row p holds the taps for an output p / phases of a sample past the middle
+// of the window, each row scaled to unity gain at DC, then the differences
+// to row p + 1 (which is the next sample's row 0 for the last).
+std::vector<float> makeResamplerTable(const ResamplerDesign& design, double cutoff) {
+  constexpr int phases = 1 << Resampler::phaseBits;
+  const int taps = design.taps;
+  const double half = taps / 2.0;
+  const double pi = 3.14159265358979323846;
+
+  std::vector<double> rows(static_cast<size_t>((phases + 1) * taps));
+  for (int p = 0; p <= phases; ++p) {
+    double* row = rows.data() + p * taps;
+    double sum = 0;
+    for (int t = 0; t < taps; ++t) {
+      double x = t - (half - 1) - static_cast<double>(p) / phases;
+      double u = x / half;
+      double window = u * u < 1 ? besselI0(design.beta * std::sqrt(1 - u * u)) : 1.0;
+      // x is 0 only at the centre tap of row 0 (and otherwise at least 1 / phases)
+      double sinc = std::abs(x) < 1e-12 ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+      row[t] = cutoff * sinc * window / besselI0(design.beta);
+      sum += row[t];
+    }
+    for (int t = 0; t < taps; ++t) row[t] /= sum;
+  }
+
+  std::vector<float> table(static_cast<size_t>(phases * 2 * taps));
+  for (int p = 0; p < phases; ++p)
+    for (int t = 0; t < taps; ++t) {
+      double a = rows[static_cast<size_t>(p * taps + t)];
+      double b = rows[static_cast<size_t>((p + 1) * taps + t)];
+      table[static_cast<size_t>(p * 2 * taps + t)] = static_cast<float>(a);
+      table[static_cast<size_t>(p * 2 * taps + taps + t)] = static_cast<float>(b - a);
+    }
+  return table;
+}
+
+struct ResamplerTables {
+  std::vector<float> tables[numResamplerDesigns][Resampler::numBands];
+
+  ResamplerTables() {
+    for (int d = 0; d < numResamplerDesigns; ++d)
+      for (int band = 0; band < Resampler::numBands; ++band)
+        tables[d][band] = makeResamplerTable(
+            resamplerDesigns[d], resamplerDesigns[d].cutoff / Resampler::bandIncrement(band));
+  }
+};
+
+// built on first use: prepare() makes sure that is not the audio thread
+const ResamplerTables& resamplerTables() {
+  static const ResamplerTables tables;
+  return tables;
+}
+
+}  // namespace
+
+double Resampler::bandIncrement(int band) { return std::exp2(0.5 * band); }
+
+const float* Resampler::getTable(int taps, int band) {
+  return resamplerTables().tables[designIndex(taps)][band].data();
+}
+
+void Resampler::prepare(int maximumBlockSize) {
+  blockSize = std::max(1, maximumBlockSize);
+  // the history, one block's input at the highest increment, and the
+  // history a change to more taps adds
+  auto size = static_cast<size_t>(2 * maxTaps + std::ceil(blockSize * maxIncrement) + 1);
+  input.assign(size, 0.0f);
+  setTaps(taps);
+  reset();
+}
+
+void Resampler::reset() {
+  held = 0;
+  position = 0;
+}
+
+void Resampler::setTaps(int count) {
+  int design = designIndex(count);
+  int next = resamplerDesigns[design].taps;
+  for (int band = 0; band < numBands; ++band) tables[band] = getTable(next, band);
+
+  // keep the middle of the window on the same input sample: fewer taps
+  // skip the oldest history, more taps see silence before it
+  int shift = next / 2 - taps / 2;
+  if (shift < 0) {
+    position += static_cast<uint64_t>(-shift) << 32;
+  } else if (shift > 0 && held > 0) {
+    std::copy_backward(input.begin(), input.begin() + held, input.begin() + held + shift);
+    std::fill(input.begin(), input.begin() + shift, 0.0f);
+    held += shift;
+  }
+  taps = next;
+}
+
 }  // namespace ky
\ No newline at end of file
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <mutex>
 #include <vector>
 
+#include "Dispatch.h"
+
 namespace ky {
 
 inline float sin7(float x) {
@@ -45,10 +53,15 @@ struct PlaybackRateObserver {
   PlaybackRateObserver* nextObserver{nullptr};
   virtual void onPlaybackRateChange(float samplerate);
   PlaybackRateObserver();
+  PlaybackRateObserver(PlaybackRateObserver const& other);
+  PlaybackRateObserver& operator=(PlaybackRateObserver const& other);
+  virtual ~PlaybackRateObserver();
 };
 
 class PlaybackRateSubject {
   PlaybackRateObserver* list{nullptr};
+  float samplerate{1};  // the most recent rate, given to new observers
+  std::mutex mutex;
   PlaybackRateSubject() {}
 
  public:
@@ -57,6 +70,7 @@ class PlaybackRateSubject {
 
   void notifyObservers(float samplerate);
   void addObserver(PlaybackRateObserver* observer);
+  void removeObserver(PlaybackRateObserver* observer);
   static PlaybackRateSubject& instance();
 };
 
@@ -102,18 +116,103 @@ class STFT : public PlaybackRateObserver {
   }
 };
 
-// https://github.com/grame-cncm/faust/blob/master-dev/examples/generator/noise.dsp
+// Philox4x32-10, a counter-based generator
+// https://www.thesalmons.org/john/random123/papers/random123sc11.pdf
+//
+// Output n is a pure function of (seed, stream, n), so there is no hidden
+// shared state: each instance is independent, and instances with the same
+// seed but different streams can run in parallel without overlapping. Numbers
+// are made `lanes` counters at a time by kernels().philox, vectorized for the
+// widest instruction set the CPU has (the output is the same on all of them).
+class Random {
+ public:
+  static constexpr int lanes = Kernels::philoxLanes;
+
+  explicit Random(uint64_t s = 0, uint32_t stream = 0) { seed(s, stream); }
+
+  void seed(uint64_t s, uint32_t stream = 0) {
+    key[0] = static_cast<uint32_t>(s);
+    key[1] = static_cast<uint32_t>(s >> 32);
+    id = stream;
+    counter = 0;
+    next = size;
+  }
+
+  // raw 32-bit output
+  uint32_t bits() {
+    if (next == size) refill();
+    return block[next++];
+  }
+
+  // on [0, 1)
+  float uniform() { return (bits() >> 8) * 0x1p-24f; }
+
+  // on [-1, 1)
+  float bipolar() { return static_cast<int32_t>(bits()) * 0x1p-31f; }
+
+  // fill a whole block on [-1, 1)
+  void fill(float* output, int count) {
+    while (count > 0) {
+      if (next == size) refill();
+      int n = std::min(count, size - next);
+      const uint32_t* source = block + next;
+      for (int i = 0; i < n; ++i) {
+        output[i] = static_cast<int32_t>(source[i]) * 0x1p-31f;
+      }
+      next += n;
+      output += n;
+      count -= n;
+    }
+  }
+
+  // fill a whole block with normally distributed values (mean 0, sd 1)
+  void fillGaussian(float* output, int count) {
+    constexpr float twoPi = 6.28318530717958647692f;
+    while (count > 0) {
+      // Box-Muller turns a fresh block of uniforms into a block of normals
+      refill();
+      float normal[size];
+      for (int i = 0; i < size / 2; ++i) {
+        // u1 on (0, 1] so the log is finite
+        float u1 = ((block[2 * i] >> 8) + 1) * 0x1p-24f;
+        float u2 = (block[2 * i + 1] >> 8) * 0x1p-24f;
+        float r = std::sqrt(-2.0f * std::log(u1));
+        normal[2 * i] = r * std::cos(twoPi * u2);
+        normal[2 * i + 1] = r * std::sin(twoPi * u2);
+      }
+      next = size;
+
+      int n = std::min(count, size);
+      std::copy_n(normal, n, output);
+      output += n;
+      count -= n;
+    }
+  }
+
+ private:
+  static constexpr int size = 4 * lanes;
+
+  void refill() {
+    kernels().philox(counter, id, key, block);
+    counter += lanes;
+    next = 0;
+  }
+
+  uint32_t block[size]{};
+  uint32_t key[2]{};
+  uint32_t id = 0;
+  uint64_t counter = 0;
+  int next = size;
+};
+
+// white noise on [-1, 1)
 class Noise {
-  int state = 0;
+  Random random;
 
  public:
-  void seed(int s) { state = s; }
-  float operator()() {
-    int v = state;
-    state += 12345;
-    state *= 1103515245;
-    return v / 2147483647.0f;
-  }
+  void seed(int s) { random.seed(static_cast<uint32_t>(s)); }
+  void fill(float* output, int count) { random.fill(output, count); }
+  float operator()() { return random.bipolar(); }
 };
 
 class History {
@@ -137,17 +236,107 @@ struct FloatVectorWrap : public std::vector<float> {
   }
 };
 
+// Band-limited resampling of a stream by any ratio up to maxIncrement, for
+// playing samples at a pitch. Each output is an inner product of `taps` input
+// samples with a row of a windowed-sinc table, interpolated between the
+// 1 << phaseBits phases it holds. The tables are built once per process and
+// shared; there is one per tap count and per half-octave of increment, so
+// pitching up lowers the cutoff (below the new Nyquist) instead of aliasing.
+//
+// The window is centred taps / 2 - 1 samples ahead of the read position, so
+// output k is the input at k * increment + taps / 2 - 1: the first
+// taps / 2 - 1 input samples are skipped, not delayed, and there is no
+// latency to compensate. setTaps() keeps the window centred on the same input
+// sample, so playback carries on without a jump; the read-ahead then stays
+// that of the old count, which is off from a fresh start at the new one by
+// the change in taps / 2.
+class Resampler {
+ public:
+  static constexpr int phaseBits = Kernels::polyphaseBits;
+  static constexpr int maxTaps = 32;
+  static constexpr double maxIncrement = 4;  // no more than the fewest taps
+  static constexpr int numBands = 5;         // increments 1, 1.4, 2, 2.8 and 4
+
+  // not on the audio thread: builds the tables on first use and sizes the
+  // input for blocks of up to maximumBlockSize
+  void prepare(int maximumBlockSize);
+  void reset();  // forgets the input so far
+
+  // 4, 8, 16 or 32 (any other count is rounded up); the history and the
+  // read-ahead are kept (see above)
+  void setTaps(int taps);
+  int getTaps() const { return taps; }
+
+  // the table for `taps` taps and increments up to bandIncrement(band)
+  static const float* getTable(int taps, int band);
+  static double bandIncrement(int band);
+
+  // output[0, numSamples): the input `increment` samples apart (the pitch
+  // ratio). read(float* destination, int count) supplies the input as it is
+  // needed, count samples at a time.
+  template <typename Read>
+  void process(float* output, int numSamples, double increment, Read&& read) {
+    assert(!input.empty());
+    increment = std::clamp(increment, 1.0 / 65536, maxIncrement);
+    auto step = static_cast<uint64_t>(increment * 4294967296.0);
+    int band = 0;
+    while (band < numBands - 1 && increment > bandIncrement(band)) ++band;
+
+    for (int done = 0; done < numSamples;) {
+      int n = std::min(numSamples - done, blockSize);
+      int needed = static_cast<int>((position + step * static_cast<uint64_t>(n - 1)) >> 32) + taps;
+      if (needed > held) {
+        read(input.data() + held, needed - held);
+        held = needed;
+      }
+      kernels().polyphase(input.data(), tables[band], taps, position, step, output + done, n);
+      position += step * static_cast<uint64_t>(n);
+
+      // keep what the next output reads onwards
+      int used = static_cast<int>(position >> 32);
+      std::copy(input.begin() + used, input.begin() + held, input.begin());
+      held -= used;
+      position -= static_cast<uint64_t>(used) << 32;
+      done += n;
+    }
+  }
+
+ private:
+  std::vector<float> input;  // the history, then the input read ahead
+  const float* tables[numBands]{};
+  int taps = 16;
+  int blockSize = 0;
+  int held = 0;           // samples in `input`
+  uint64_t position = 0;  // of the next output in `input`, 32.32
+};
+
+// Loops a clip held in memory, at any pitch
 class ClipPlayer {
-  FloatVectorWrap data;
+  std::vector<float> data;
+  size_t next = 0;  // the clip sample the resampler reads next
+  Resampler resampler;
 
  public:
   void addSample(float f) { data.push_back(f); }
-
-  // input on (0, 1)
-  // linear interpolation
-  float operator()(float phase) {
-    if (data.empty()) return 0.0f;
-    return data(phase * data.size());
+  void prepare(int maximumBlockSize) { resampler.prepare(maximumBlockSize); }
+  void setTaps(int taps) { resampler.setTaps(taps); }
+
+  // `increment` clip samples per output sample: 2 is an octave up
+  void render(float* output, int numSamples, double increment) {
+    if (data.empty()) {
+      std::fill(output, output + numSamples, 0.0f);
+      return;
+    }
+    resampler.process(output, numSamples, increment, [this](float* destination, int count) {
+      while (count > 0) {
+        size_t n = std::min(static_cast<size_t>(count), data.size() - next);
+        std::copy(data.begin() + static_cast<std::ptrdiff_t>(next),
+                  data.begin() + static_cast<std::ptrdiff_t>(next + n), destination);
+        destination += n;
+        count -= static_cast<int>(n);
+        next = (next + n) % data.size();
+      }
+    });
   }
 };
 
@@ -175,6 +364,7 @@ class DelayLine {
 class KarplusStrong : public PlaybackRateObserver {
   DelayLine delayLine;
   History history;
+  Random random;
   float _beta = 0;
   float _decay = 1;
   float _delay = 0;
@@ -186,11 +376,12 @@ class KarplusStrong : public PlaybackRateObserver {
     _delay = samplerate / hertz;
     delayLine.resize(1 + static_cast<size_t>(samplerate / hertz));
     for (size_t i = 0; i < delayLine.size(); ++i) {
-      delayLine.write(2.0f * (std::rand() / static_cast<float>(RAND_MAX)) -
-                      1.0f);
+      delayLine.write(random.bipolar());
     }
   }
 
+  void seed(uint64_t s) { random.seed(s); }
+
   float operator()() {
     if (delayLine.size() == 0) return 0.0;
     float f = delayLine.read(_delay);
@@ -287,6 +478,129 @@ class SchroederReverb {
   }
 };
 
+// delay of `seconds`, rounded to whole samples at `sampleRate`
+constexpr size_t samplesAt(double seconds, unsigned sampleRate) {
+  return static_cast<size_t>(seconds * sampleRate + 0.5);
+}
+
+// Fixed-length versions of CombFeedback and AllPass. The delay and gain are
+// template parameters (gain in thousandths, since float template parameters
+// are not yet portable), and the delay line is an inline std::array, so a
+// filter is one flat object with no indirection. The delay line is exactly as
+// long as the delay, so each sample reads and writes the same slot; samples
+// in a block don't depend on each other and process() vectorizes.
+template <size_t DelaySamples, int FeedbackMilli>
+class FixedCombFeedback {
+  static_assert(DelaySamples > 0);
+  static constexpr float feedback = FeedbackMilli / 1000.0f;
+
+  std::array<float, DelaySamples> data{};
+  size_t next = 0;
+
+ public:
+  float operator()(float input) {
+    float output = input + feedback * data[next];
+    data[next] = output;
+    if (++next == DelaySamples) next = 0;
+    return output;
+  }
+
+  // adds the filtered input to output
+  void process(const float* input, float* output, int count) {
+    while (count > 0) {
+      int span = static_cast<int>(
+          std::min(static_cast<size_t>(count), DelaySamples - next));
+      float* d = data.data() + next;
+      for (int i = 0; i < span; ++i) {
+        float y = input[i] + feedback * d[i];
+        d[i] = y;
+        output[i] += y;
+      }
+      next += static_cast<size_t>(span);
+      if (next == DelaySamples) next = 0;
+      input += span;
+      output += span;
+      count -= span;
+    }
+  }
+};
+
+template <size_t DelaySamples, int GainMilli>
+class FixedAllPass {
+  static_assert(DelaySamples > 0);
+  static constexpr float gain = GainMilli / 1000.0f;
+
+  std::array<float, DelaySamples> data{};
+  size_t next = 0;
+
+ public:
+  float operator()(float input) {
+    float read = data[next];
+    float vn = input - gain * read;
+    data[next] = vn;
+    if (++next == DelaySamples) next = 0;
+    return read + vn * gain;
+  }
+
+  // input and output may be the same buffer
+  void process(const float* input, float* output, int count) {
+    while (count > 0) {
+      int span = static_cast<int>(
+          std::min(static_cast<size_t>(count), DelaySamples - next));
+      float* d = data.data() + next;
+      for (int i = 0; i < span; ++i) {
+        float read = d[i];
+        float vn = input[i] - gain * read;
+        d[i] = vn;
+        output[i] = read + vn * gain;
+      }
+      next += static_cast<size_t>(span);
+      if (next == DelaySamples) next = 0;
+      input += span;
+      output += span;
+      count -= span;
+    }
+  }
+};
+
+// SchroederReverb with the delays of configure() baked in for one sample rate
+template <unsigned SampleRate>
+class FixedSchroederReverb {
+  FixedCombFeedback<samplesAt(0.06712, SampleRate), 773> comb0;
+  FixedCombFeedback<samplesAt(0.06404, SampleRate), 802> comb1;
+  FixedCombFeedback<samplesAt(0.08212, SampleRate), 753> comb2;
+  FixedCombFeedback<samplesAt(0.09004, SampleRate), 733> comb3;
+  FixedAllPass<samplesAt(0.01388, SampleRate), 700> allpass0;
+  FixedAllPass<samplesAt(0.00452, SampleRate), 700> allpass1;
+  FixedAllPass<samplesAt(0.00148, SampleRate), 700> allpass2;
+
+ public:
+  float operator()(float input) {
+    float output = comb0(input) + comb1(input) + comb2(input) + comb3(input);
+    return allpass2(allpass1(allpass0(output)));
+  }
+
+  // input and output may be the same buffer
+  void process(const float* input, float* output, int count) {
+    constexpr int chunk = 64;
+    float sum[chunk];
+    while (count > 0) {
+      int n = std::min(count, chunk);
+      std::fill(sum, sum + n, 0.0f);
+      comb0.process(input, sum, n);
+      comb1.process(input, sum, n);
+      comb2.process(input, sum, n);
+      comb3.process(input, sum, n);
+      allpass0.process(sum, sum, n);
+      allpass1.process(sum, sum, n);
+      allpass2.process(sum, output, n);
+      input += n;
+      output += n;
+      count -= n;
+    }
+  }
+};
+
 class DCblock {
   float x1 = 0;
   float y1 = 0;
@@ -300,6 +614,35 @@ class DCblock {
   }
 };
 
+// Says when a signal has stayed quiet for long enough that whatever it feeds
+// (a reverb tail, say) has died away too. Fed a block at a time; a block is
+// quiet when its RMS over all channels is below the threshold, and any louder
+// block starts the count again.
+class SilenceDetector {
+  float threshold = 1e-5f;  // -100 dB
+  int64_t quiet = 0;        // samples since the last loud block
+  int64_t hold = 0;
+
+ public:
+  void setThreshold(float rms) { threshold = rms; }
+  // how long the quiet must last before isSilent()
+  void setHold(int64_t samples) { hold = samples; }
+  void reset() { quiet = 0; }
+
+  bool update(const float* const* channels, int numChannels, int numSamples) {
+    double sum = 0;
+    for (int c = 0; c < numChannels; ++c) sum += kernels().energy(channels[c], numSamples);
+    int64_t count = static_cast<int64_t>(numChannels) * numSamples;
+    if (count > 0 && sum > threshold * threshold * static_cast<double>(count))
+      quiet = 0;
+    else
+      quiet += numSamples;
+    return isSilent();
+  }
+
+  bool isSilent() const { return quiet > hold; }
+};
+
 struct Line : PlaybackRateObserver {
   float value = 0, target = 0, seconds = 1, increment = 0;
 
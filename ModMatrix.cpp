@@ -0,0 +1,99 @@
+#include "ModMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* ModMatrix::getSourceName(int source) {
+  const char* names[] = {"LFO 1", "LFO 2", "Envelope", "Random Walk"};
+  return source >= 0 && source < numSources ? names[source] : "Off";
+}
+
+const char* ModMatrix::getDestinationName(int destination) {
+  const char* names[] = {"Cutoff", "Sine Mix", "Saw Mix", "Tri Mix",
+                         "Gain", "Detune", "Reverb Mix"};
+  return destination >= 0 && destination < numDestinations ? names[destination] : "";
+}
+
+void ModMatrix::prepare(double sampleRate) {
+  samplerate = sampleRate;
+  interval = nextInterval;
+  position = 0;
+  lfoPhase.fill(0);
+  values.fill(0);
+  envelopeRising = true;
+  to.fill(0);
+  tick();
+  from = to;
+  slope.fill(0);
+}
+
+void ModMatrix::setControlInterval(int samples) { nextInterval = std::max(1, samples); }
+
+void ModMatrix::setLfoRate(int lfo, float hertz) {
+  if (lfo >= 0 && lfo < 2) lfoRate[static_cast<size_t>(lfo)] = hertz;
+}
+
+void ModMatrix::setEnvelope(float attackSeconds, float decaySeconds) {
+  attack = attackSeconds;
+  decay = decaySeconds;
+}
+
+void ModMatrix::setRandomRate(float rate) { randomRate = rate; }
+
+void ModMatrix::setSlot(int slot, int source, int destination, float amount) {
+  if (slot < 0 || slot >= numSlots) return;
+  auto& s = slots[static_cast<size_t>(slot)];
+  s.source = source < numSources ? source : -1;
+  s.destination = std::clamp(destination, 0, numDestinations - 1);
+  s.amount = amount;
+}
+
+int ModMatrix::next(int maxSamples) {
+  if (position == 0) {
+    interval = nextInterval;
+    from = to;
+    tick();
+    for (int d = 0; d < numDestinations; ++d) slope[d] = (to[d] - from[d]) / interval;
+  }
+
+  int span = std::min(maxSamples, interval - position);
+  for (int d = 0; d < numDestinations; ++d)
+    start[d] = from[d] + slope[d] * static_cast<float>(position);
+
+  position += span;
+  if (position >= interval) position = 0;
+  return span;
+}
+
+void ModMatrix::tick() {
+  const double seconds = interval / samplerate;
+
+  for (size_t l = 0; l < 2; ++l) {
+    lfoPhase[l] += lfoRate[l] * seconds;
+    lfoPhase[l] -= std::floor(lfoPhase[l]);
+    values[lfo1 + l] = static_cast<float>(std::sin(2 * 3.141592653589793 * lfoPhase[l]));
+  }
+
+  // attack to 1, then decay back to 0 and stay there until trigger()
+  float& level = values[envelope];
+  if (envelopeRising) {
+    level += static_cast<float>(seconds / std::max(attack, 1e-3f));
+    if (level >= 1) {
+      level = 1;
+      envelopeRising = false;
+    }
+  } else {
+    level = std::max(0.0f, level - static_cast<float>(seconds / std::max(decay, 1e-3f)));
+  }
+
+  // Brownian motion, reflected back into [-1, 1]
+  float& walk = values[randomWalk];
+  walk += random.bipolar() * randomRate * static_cast<float>(std::sqrt(seconds));
+  if (walk > 1) walk = 2 - walk;
+  if (walk < -1) walk = -2 - walk;
+  walk = std::clamp(walk, -1.0f, 1.0f);
+
+  to.fill(0);
+  for (const auto& s : slots)
+    if (s.source >= 0) to[s.destination] += s.amount * values[s.source];
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Library.h"
+
+// Control-rate modulation. The sources (two LFOs, an attack-decay envelope
+// and a random walk) are evaluated once every `interval` samples, summed into
+// each destination through the routing slots, and read back per sample as a
+// straight line between control points. So the cost per sample is a
+// multiply-add per destination, however many routes there are.
+//
+// Offsets are in whatever units the caller gives the slot amounts in; the
+// matrix only adds them up.
+class ModMatrix {
+ public:
+  enum Source { lfo1, lfo2, envelope, randomWalk, numSources };
+  enum Destination { cutoff, sineMix, sawMix, triMix, gain, detune, reverbMix, numDestinations };
+  static constexpr int numSlots = 5;
+  static const char* getSourceName(int source);
+  static const char* getDestinationName(int destination);
+
+  void prepare(double sampleRate);
+  void seed(uint64_t s) { random.seed(s); }
+
+  // samples between control points; takes effect at the next one
+  void setControlInterval(int samples);
+  void setLfoRate(int lfo, float hertz);
+  void setEnvelope(float attackSeconds, float decaySeconds);
+  void setRandomRate(float rate);
+
+  // route `source` to `destination`; a negative source turns the slot off
+  void setSlot(int slot, int source, int destination, float amount);
+
+  // start the envelope's attack again, from wherever it is now
+  void trigger() { envelopeRising = true; }
+
+  // Move on by up to maxSamples, stopping at the next control point.
+  // Returns how many samples the span covers; get() is valid within it.
+  int next(int maxSamples);
+
+  // offset at sample i of the current span
+  float get(Destination d, int i) const { return start[d] + slope[d] * static_cast<float>(i); }
+
+  // offset at the current position (the start of the next span)
+  float getCurrent(Destination d) const {
+    return from[d] + slope[d] * static_cast<float>(position);
+  }
+
+ private:
+  struct Slot {
+    int source = -1;
+    int destination = 0;
+    float amount = 0;
+  };
+
+  void tick();  // advance the sources by one interval and sum the routes
+
+  double samplerate = 44100;
+  int interval = 32, nextInterval = 32;
+  int position = 0;  // samples since the last control point
+
+  std::array<Slot, numSlots> slots;
+  std::array<float, numSources> values{};
+  std::array<float, numDestinations> from{}, to{}, slope{}, start{};
+
+  std::array<float, 2> lfoRate{0.1f, 0.5f};
+  std::array<double, 2> lfoPhase{};
+  float attack = 1, decay = 3;
+  bool envelopeRising = true;
+  float randomRate = 0.2f;
+  ky::Random random;
+};
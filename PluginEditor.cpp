@@ -5,20 +5,20 @@
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(
     AudioPluginAudioProcessor& p)
-    : AudioProcessorEditor(&p), processorRef(p) {
-  setSize(660, 722);
+    : AudioProcessorEditor(&p),
+      processorRef(p),
+      analyser(p.getDryTap(), p.getOutputTap()) {
+#if KY_ENABLE_PROFILER
+  setSize(960, 1082);
+#else
+  setSize(960, 1042);
+#endif
 
-  churchImage = juce::ImageFileFormat::loadFrom(
-      juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("church.png"));
+  // 🖼️ The pictures decode in the background; show whatever is ready now and
+  // swap in the rest when BackdropImages says they have arrived
+  backdrops->addChangeListener(this);
+  updateBackdrop();
 
-  caveImage = juce::ImageFileFormat::loadFrom(
-      juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("cave.png"));
-
-  roomImage = juce::ImageFileFormat::loadFrom(
-      juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("room.png")); 
-
-  imageDisplay.setImage(churchImage, juce::RectanglePlacement::centred);
-      
   attachment.push_back(
       std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
           processorRef.apvts, "gain", gainSlider));
@@ -36,15 +36,46 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(
           processorRef.apvts, "triMix", triMixSlider));
   attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
           processorRef.apvts, "cutoff", cutoffSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "resonance", resonanceSlider));
   attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
           processorRef.apvts, "lfoDepth", lfoDepthSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "lfoRate", lfoRateSlider));
   attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
           processorRef.apvts, "reverbMix", reverbMixSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "pluckMix", pluckMixSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "unison", unisonSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "unisonSpread", unisonSpreadSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "stereoWidth", stereoWidthSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "panSpread", panSpreadSlider));
+  attachment.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          processorRef.apvts, "panMotion", panMotionSlider));
 
   irSelectBox.addItem("Church", 1);
   irSelectBox.addItem("Cave", 2);
   irSelectBox.addItem("Room", 3);
 
+  progressionBox.addItemList(PresetBank::getProgressionNames(), 1);
+  scaleBox.addItemList(Tuning::getModeNames(), 1);
+  temperamentBox.addItemList(Tuning::getTemperamentNames(), 1);
+  for (auto [box, id] : {std::pair{&clipKeyBox, "clipKey"}, std::pair{&clipTapsBox, "clipTaps"}})
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(processorRef.apvts.getParameter(id)))
+      box->addItemList(choice->choices, 1);
+
+  // 🎛️ Factory programs; the processor applies them on the audio thread
+  for (int i = 0; i < processorRef.getNumPrograms(); ++i)
+    programBox.addItem(processorRef.getProgramName(i), i + 1);
+  programBox.setSelectedId(processorRef.getCurrentProgram() + 1, juce::dontSendNotification);
+  programBox.onChange = [this] {
+    processorRef.setCurrentProgram(programBox.getSelectedId() - 1);
+  };
+
   addAndMakeVisible(gainSlider);
   gainSlider.setTextValueSuffix(" dB (gain)");
   addAndMakeVisible(frequencySlider);
@@ -59,19 +90,56 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(
   triMixSlider.setTextValueSuffix("(tri mix)");
   addAndMakeVisible(cutoffSlider);
   cutoffSlider.setTextValueSuffix(" Hz (cutoff)");
+  addAndMakeVisible(resonanceSlider);
+  resonanceSlider.setTextValueSuffix(" Q (resonance)");
   addAndMakeVisible(lfoDepthSlider);
   lfoDepthSlider.setTextValueSuffix(" (LFO depth)");
+  addAndMakeVisible(lfoRateSlider);
+  lfoRateSlider.setTextValueSuffix(" Hz (LFO rate)");
   addAndMakeVisible(reverbMixSlider);
   reverbMixSlider.setTextValueSuffix(" (dry|wet)");
+  addAndMakeVisible(pluckMixSlider);
+  pluckMixSlider.setTextValueSuffix(" (pluck mix)");
+  addAndMakeVisible(unisonSlider);
+  unisonSlider.setTextValueSuffix(" (voices)");
+  addAndMakeVisible(unisonSpreadSlider);
+  unisonSpreadSlider.setTextValueSuffix(" ct (spread)");
+  addAndMakeVisible(stereoWidthSlider);
+  stereoWidthSlider.setTextValueSuffix(" (width)");
+  addAndMakeVisible(panSpreadSlider);
+  panSpreadSlider.setTextValueSuffix(" (partial pan)");
+  addAndMakeVisible(panMotionSlider);
+  panMotionSlider.setTextValueSuffix(" Hz (pan motion)");
 
   addAndMakeVisible(irSelectBox);
+  addAndMakeVisible(progressionBox);
+  addAndMakeVisible(scaleBox);
+  addAndMakeVisible(temperamentBox);
+  addAndMakeVisible(clipKeyBox);
+  addAndMakeVisible(clipTapsBox);
+  addAndMakeVisible(programBox);
+#if KY_ENABLE_PROFILER
+  addAndMakeVisible(loadLabel);
+  loadLabel.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 13.0f, juce::Font::plain));
+#endif
   addAndMakeVisible(imageDisplay);
+  addAndMakeVisible(analyser);
 
   // ✅ Start the timer after everything is set up
   startTimerHz(10);
 
   irAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
     processorRef.apvts, "irChoice", irSelectBox);
+  progressionAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+    processorRef.apvts, "progression", progressionBox);
+  scaleAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+    processorRef.apvts, "scale", scaleBox);
+  temperamentAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+    processorRef.apvts, "temperament", temperamentBox);
+  clipKeyAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+    processorRef.apvts, "clipKey", clipKeyBox);
+  clipTapsAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+    processorRef.apvts, "clipTaps", clipTapsBox);
 
 
   chooser = std::make_unique<juce::FileChooser>(
@@ -84,29 +152,35 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(
       juce::File file = c.getResult();
       if (!file.exists()) return;
 
-      juce::AudioFormatManager formatManager;
-      formatManager.registerBasicFormats();
-      std::unique_ptr<juce::AudioFormatReader> reader(
-          formatManager.createReaderFor(file));
-      if (reader == nullptr) return;
-
-      auto buffer = std::make_unique<juce::AudioBuffer<float>>(
-          static_cast<int>(reader->numChannels),
-          static_cast<int>(reader->lengthInSamples));
-
-      reader->read(buffer.get(), 0, static_cast<int>(reader->lengthInSamples),
-                   0, true, true);
-
-      processorRef.setBuffer(std::move(buffer));
+      // only the header is parsed here; the audio is streamed from disk
+      processorRef.openSampleFile(file);
     };
 
     chooser->launchAsync(juce::FileBrowserComponent::canSelectFiles, fn);
   };
 
   addAndMakeVisible(openButton);
+
+  // 🎼 A Scala scale for the "Custom" choice; it is used from the next chord
+  scalaChooser = std::make_unique<juce::FileChooser>(
+      "Select a Scala scale...",
+      juce::File::getSpecialLocation(juce::File::userDesktopDirectory), "*.scl");
+  scalaButton.setButtonText("load Scala scale");
+  scalaButton.onClick = [this] {
+    scalaChooser->launchAsync(juce::FileBrowserComponent::canSelectFiles,
+                              [this](const juce::FileChooser& c) {
+      juce::File file = c.getResult();
+      if (!file.existsAsFile()) return;
+      if (processorRef.loadScalaFile(file))
+        scaleBox.setSelectedItemIndex(Tuning::numModes);  // Custom
+    });
+  };
+  addAndMakeVisible(scalaButton);
 }
 
-AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor() {}
+AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor() {
+  backdrops->removeChangeListener(this);
+}
 
 void AudioPluginAudioProcessorEditor::paint(juce::Graphics& g) {
   g.fillAll(
@@ -115,8 +189,17 @@ void AudioPluginAudioProcessorEditor::paint(juce::Graphics& g) {
 
 void AudioPluginAudioProcessorEditor::resized() {
   auto area = getLocalBounds();
+  analyser.setBounds(area.removeFromRight(300));
   auto height = 40;
-  openButton.setBounds(area.removeFromTop(height));
+  {
+    // the sample file, its key and the resampling quality
+    auto row = area.removeFromTop(height);
+    int third = row.getWidth() / 3;
+    openButton.setBounds(row.removeFromLeft(third));
+    clipKeyBox.setBounds(row.removeFromLeft(third));
+    clipTapsBox.setBounds(row);
+  }
+  programBox.setBounds(area.removeFromTop(height));
   gainSlider.setBounds(area.removeFromTop(height));
   frequencySlider.setBounds(area.removeFromTop(height));
   chordRateSlider.setBounds(area.removeFromTop(height));
@@ -124,9 +207,35 @@ void AudioPluginAudioProcessorEditor::resized() {
   sawMixSlider.setBounds(area.removeFromTop(height));
   triMixSlider.setBounds(area.removeFromTop(height));
   cutoffSlider.setBounds(area.removeFromTop(height));
+  resonanceSlider.setBounds(area.removeFromTop(height));
   lfoDepthSlider.setBounds(area.removeFromTop(height));
+  lfoRateSlider.setBounds(area.removeFromTop(height));
   reverbMixSlider.setBounds(area.removeFromTop(height));
+  pluckMixSlider.setBounds(area.removeFromTop(height));
+  {
+    auto row = area.removeFromTop(height);
+    int third = row.getWidth() / 3;
+    unisonSlider.setBounds(row.removeFromLeft(third));
+    unisonSpreadSlider.setBounds(row.removeFromLeft(third));
+    stereoWidthSlider.setBounds(row);
+  }
+  {
+    auto row = area.removeFromTop(height);
+    panSpreadSlider.setBounds(row.removeFromLeft(row.getWidth() / 2));
+    panMotionSlider.setBounds(row);
+  }
   irSelectBox.setBounds(area.removeFromTop(height));
+  progressionBox.setBounds(area.removeFromTop(height));
+  {
+    auto row = area.removeFromTop(height);
+    int third = row.getWidth() / 3;
+    scaleBox.setBounds(row.removeFromLeft(third));
+    temperamentBox.setBounds(row.removeFromLeft(third));
+    scalaButton.setBounds(row);
+  }
+#if KY_ENABLE_PROFILER
+  loadLabel.setBounds(area.removeFromTop(height));
+#endif
 
   //imageDisplay.setBounds(getWidth() - 200, 0, 200, 200);
   imageDisplay.setBounds(area.removeFromTop(260));
@@ -135,13 +244,44 @@ void AudioPluginAudioProcessorEditor::resized() {
 
 void AudioPluginAudioProcessorEditor::timerCallback()
 {
-    // 👇 Example: switch the displayed image based on IR selection
-    auto irChoice = processorRef.apvts.getParameter("irChoice")->getValue(); // 0, 1, or 2
-
-    if (irChoice == 0)
-        imageDisplay.setImage(churchImage, juce::RectanglePlacement::centred);
-    else if (irChoice == 0.5)
-        imageDisplay.setImage(caveImage, juce::RectanglePlacement::centred);
-    else if (irChoice == 1)
-        imageDisplay.setImage(roomImage, juce::RectanglePlacement::centred);
+#if KY_ENABLE_PROFILER
+    // 📈 Per-stage load of the blocks rendered since the last tick
+    Profiler::Report report;
+    if (processorRef.getProfiler().drain(report)) {
+        juce::String text = "load " + juce::String(report.load * 100.0, 1) + "% |";
+        for (int s = 0; s < Profiler::numStages; ++s)
+            text << " " << Profiler::getStageName(s) << " "
+                 << juce::String(report.stageLoad[static_cast<size_t>(s)] * 100.0, 1) << "%";
+        text << " | peak " << juce::String(report.peakBlockSeconds * 1000.0, 2) << " ms"
+             << " | xruns " << report.xruns;
+        loadLabel.setText(text, juce::dontSendNotification);
+    }
+#endif
+
+
+    // 📊 Spectrum and scope: the FFTs run here, never on the audio thread
+    analyser.update();
+
+    // 👇 Switch the displayed image when the IR selection changes
+    updateBackdrop();
+}
+
+void AudioPluginAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    updateBackdrop();
+}
+
+void AudioPluginAudioProcessorEditor::updateBackdrop()
+{
+    int irChoice = static_cast<int>(*processorRef.apvts.getRawParameterValue("irChoice")); // 0, 1, or 2
+    if (irChoice == shownIR && shownValid)
+        return; // nothing changed, so don't touch the image (or repaint)
+
+    auto image = backdrops->get(irChoice);
+    if (irChoice == shownIR && !image.isValid())
+        return; // still decoding
+
+    imageDisplay.setImage(image, juce::RectanglePlacement::centred);
+    shownIR = irChoice;
+    shownValid = image.isValid();
 }
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "AnalyserView.h"
+#include "BackdropImages.h"
 #include "PluginProcessor.h"
 
 //==============================================================================
 class AudioPluginAudioProcessorEditor final
-    : public juce::AudioProcessorEditor, private juce::Timer {
+    : public juce::AudioProcessorEditor,
+      private juce::Timer,
+      private juce::ChangeListener {
  public:
   explicit AudioPluginAudioProcessorEditor(AudioPluginAudioProcessor&);
   ~AudioPluginAudioProcessorEditor() override;
@@ -25,14 +29,37 @@ class AudioPluginAudioProcessorEditor final
   juce::Slider sawMixSlider;
   juce::Slider triMixSlider;
   juce::Slider cutoffSlider;
+  juce::Slider resonanceSlider;
   juce::Slider lfoDepthSlider;
+  juce::Slider lfoRateSlider;
   juce::Slider reverbMixSlider;
+  juce::Slider pluckMixSlider;
+  juce::Slider unisonSlider;
+  juce::Slider unisonSpreadSlider;
+  juce::Slider stereoWidthSlider;
+  juce::Slider panSpreadSlider;
+  juce::Slider panMotionSlider;
   juce::ComboBox irSelectBox;
+  juce::ComboBox progressionBox;
+  juce::ComboBox scaleBox;
+  juce::ComboBox temperamentBox;
+  juce::ComboBox clipKeyBox;
+  juce::ComboBox clipTapsBox;
+  juce::TextButton scalaButton;
+  juce::ComboBox programBox;
+#if KY_ENABLE_PROFILER
+  juce::Label loadLabel;
+#endif
 
-  juce::Image churchImage, caveImage, roomImage;
+  juce::SharedResourcePointer<BackdropImages> backdrops;
   juce::ImageComponent imageDisplay;
+  AnalyserView analyser;
+  int shownIR = -1;          // which picture imageDisplay holds
+  bool shownValid = false;   // false until that picture has been decoded
 
   void timerCallback() override;
+  void changeListenerCallback(juce::ChangeBroadcaster*) override;
+  void updateBackdrop();
 
 
   std::vector<
@@ -42,10 +69,16 @@ class AudioPluginAudioProcessorEditor final
       std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>> 
       buttonAttachments;
   std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> irAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> progressionAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> scaleAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> temperamentAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> clipKeyAttachment;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> clipTapsAttachment;
     
 
   juce::TextButton openButton;
   std::unique_ptr<juce::FileChooser> chooser;
+  std::unique_ptr<juce::FileChooser> scalaChooser;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioPluginAudioProcessorEditor)
 };
@@ -25,6 +25,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout parameters() {
   
   parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
         ParameterID{"cutoff", 1}, "Cutoff Frequency", 100.0f, 10000.0f, 2000.0f));
+
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"resonance", 1}, "Resonance",
+        juce::NormalisableRange<float>(0.5f, 10.0f, 0.0f, 0.4f), 0.7f));
   
   parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
         ParameterID{"lfoDepth", 1}, "LFO Depth", 0.0f, 1.0f, 0.2f));
@@ -32,11 +36,87 @@ juce::AudioProcessorValueTreeState::ParameterLayout parameters() {
   parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
         ParameterID{"reverbMix", 1}, "Reverb Mix", 0.0f, 1.0f, 0.5f));
   
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"pluckMix", 1}, "Pluck Mix", 0.0f, 1.0f, 0.3f));
+
   parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
         ParameterID{"irChoice", 1}, "IR Choice",
         juce::StringArray{"Church", "Cave", "Room"},
         0  // Default to Church
   ));
+
+  parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"progression", 1}, "Chord Progression",
+        PresetBank::getProgressionNames(), 0));
+
+  // 👥 Unison voices per partial, their detune and their stereo spread
+  parameter_list.push_back(std::make_unique<juce::AudioParameterInt>(
+        ParameterID{"unison", 1}, "Unison Voices", 1, AdditiveSynth::maxUnison, 1));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"unisonSpread", 1}, "Unison Spread",
+        juce::NormalisableRange<float>(0.0f, 50.0f), 12.0f));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"stereoWidth", 1}, "Stereo Width", 0.0f, 1.0f, 0.7f));
+
+  // ↔️ Where the partials sit across the stereo field, and how fast they drift
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"panSpread", 1}, "Partial Pan Spread", 0.0f, 1.0f, 0.5f));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"panMotion", 1}, "Pan Motion",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.0f, 0.5f), 0.0f));
+
+  // 🎼 What each chord is built from: a mode in a temperament, or the Scala
+  // scale loaded with loadScalaFile()
+  parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"scale", 1}, "Scale", Tuning::getModeNames(), Tuning::majorPentatonic));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"temperament", 1}, "Temperament", Tuning::getTemperamentNames(),
+        Tuning::just));
+
+  // 🎞️ The sample file's key, to follow the chords from (Off plays it as
+  // recorded), and the length of the resampling filter
+  parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"clipKey", 1}, "Sample Key",
+        juce::StringArray{"Off", "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"},
+        0));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"clipTaps", 1}, "Sample Quality",
+        juce::StringArray{"4 taps", "8 taps", "16 taps", "32 taps"}, 2));
+
+  // 🌀 Modulation: the sources' rates and shapes, then the routing slots
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"lfoRate", 1}, "LFO 1 Rate",
+        juce::NormalisableRange<float>(0.01f, 10.0f, 0.0f, 0.3f), 0.1f));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"lfo2Rate", 1}, "LFO 2 Rate",
+        juce::NormalisableRange<float>(0.01f, 10.0f, 0.0f, 0.3f), 0.5f));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"envAttack", 1}, "Envelope Attack",
+        juce::NormalisableRange<float>(0.01f, 5.0f, 0.0f, 0.5f), 1.0f));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"envDecay", 1}, "Envelope Decay",
+        juce::NormalisableRange<float>(0.05f, 10.0f, 0.0f, 0.5f), 3.0f));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID{"walkRate", 1}, "Random Walk Rate",
+        juce::NormalisableRange<float>(0.01f, 5.0f, 0.0f, 0.5f), 0.2f));
+  parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID{"controlRate", 1}, "Control Rate",
+        juce::StringArray{"16 samples", "32 samples", "64 samples"}, 1));
+
+  juce::StringArray sources{"Off"}, destinations;
+  for (int s = 0; s < ModMatrix::numSources; ++s) sources.add(ModMatrix::getSourceName(s));
+  for (int d = 0; d < ModMatrix::numDestinations; ++d)
+    destinations.add(ModMatrix::getDestinationName(d));
+
+  for (int slot = 1; slot < ModMatrix::numSlots; ++slot) {
+    juce::String id = "mod" + juce::String(slot), name = "Mod " + juce::String(slot);
+    parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+          ParameterID{id + "Source", 1}, name + " Source", sources, 0));
+    parameter_list.push_back(std::make_unique<juce::AudioParameterChoice>(
+          ParameterID{id + "Destination", 1}, name + " Destination", destinations, 0));
+    parameter_list.push_back(std::make_unique<juce::AudioParameterFloat>(
+          ParameterID{id + "Amount", 1}, name + " Amount", -1.0f, 1.0f, 0.0f));
+  }
   
 
 
@@ -55,9 +135,51 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
 #endif
               ),
       apvts(*this, nullptr, "Parameters", parameters()) {
+  // every instance gets its own detune and pluck noise; drawing the seeds
+  // here keeps the shared system generator off the audio thread
+  auto& system = juce::Random::getSystemRandom();
+  synth.setSeed(static_cast<uint64_t>(system.nextInt64()));
+  strings.seed(static_cast<uint64_t>(system.nextInt64()));
+  matrix.seed(static_cast<uint64_t>(system.nextInt64()));
+
+  for (int slot = 1; slot < ModMatrix::numSlots; ++slot) {
+    juce::String id = "mod" + juce::String(slot);
+    modSlots[static_cast<size_t>(slot - 1)] = {apvts.getRawParameterValue(id + "Source"),
+                                               apvts.getRawParameterValue(id + "Destination"),
+                                               apvts.getRawParameterValue(id + "Amount")};
+  }
+
+  auto raw = [this](const char* id) { return apvts.getRawParameterValue(id); };
+  live = {.controlRate = raw("controlRate"),
+          .lfoRate = raw("lfoRate"),
+          .lfo2Rate = raw("lfo2Rate"),
+          .envAttack = raw("envAttack"),
+          .envDecay = raw("envDecay"),
+          .walkRate = raw("walkRate"),
+          .lfoDepth = raw("lfoDepth"),
+          .resonance = raw("resonance"),
+          .unison = raw("unison"),
+          .unisonSpread = raw("unisonSpread"),
+          .stereoWidth = raw("stereoWidth"),
+          .panSpread = raw("panSpread"),
+          .panMotion = raw("panMotion"),
+          .progression = raw("progression"),
+          .clipKey = raw("clipKey"),
+          .clipTaps = raw("clipTaps"),
+          .frequency = apvts.getParameter("frequency"),
+          .chordRate = apvts.getParameter("chordRate")};
+  for (auto [ramp, id] : {std::pair{&gainRamp, "gain"}, std::pair{&sineMixRamp, "sineMix"},
+                          std::pair{&sawMixRamp, "sawMix"}, std::pair{&triMixRamp, "triMix"},
+                          std::pair{&cutoffRamp, "cutoff"}, std::pair{&reverbMixRamp, "reverbMix"},
+                          std::pair{&pluckMixRamp, "pluckMix"}})
+    ramp->parameter = apvts.getParameter(id);
 }
 
-AudioPluginAudioProcessor::~AudioPluginAudioProcessor() {}
+AudioPluginAudioProcessor::~AudioPluginAudioProcessor() {
+  cancelPendingUpdate();
+  stream.reset();
+  streamThread.stopThread(1000);
+}
 
 //==============================================================================
 const juce::String AudioPluginAudioProcessor::getName() const {
@@ -88,23 +210,25 @@ bool AudioPluginAudioProcessor::isMidiEffect() const {
 #endif
 }
 
-double AudioPluginAudioProcessor::getTailLengthSeconds() const { return 0.0; }
-
-int AudioPluginAudioProcessor::getNumPrograms() {
-  return 1;  // NB: some hosts don't cope very well if you tell them there are 0
-             // programs, so this should be at least 1, even if you're not
-             // really implementing programs.
+// how long the plucks ring plus how long the reverb carries on after them
+// (the pad itself is a drone and never stops)
+double AudioPluginAudioProcessor::getTailLengthSeconds() const {
+  return tailSeconds.load(std::memory_order_relaxed);
 }
 
-int AudioPluginAudioProcessor::getCurrentProgram() { return 0; }
+int AudioPluginAudioProcessor::getNumPrograms() { return presets.size(); }
 
+int AudioPluginAudioProcessor::getCurrentProgram() { return presets.getCurrent(); }
+
+// Hosts call this from either thread. The audio thread applies it at the top
+// of the next block; until there is one (before prepareToPlay), apply it here.
 void AudioPluginAudioProcessor::setCurrentProgram(int index) {
-  juce::ignoreUnused(index);
+  presets.request(index);
+  if (getSampleRate() <= 0) presets.applyPending();
 }
 
 const juce::String AudioPluginAudioProcessor::getProgramName(int index) {
-  juce::ignoreUnused(index);
-  return {};
+  return presets.getName(index);
 }
 
 void AudioPluginAudioProcessor::changeProgramName(int index,
@@ -119,21 +243,54 @@ void AudioPluginAudioProcessor::prepareToPlay(double sampleRate,
 
   ky::setPlaybackRate(static_cast<float>(sampleRate));
 
-  // ✅ Prepare convolution reverb
+#if KY_ENABLE_PROFILER
+  profiler.prepare(sampleRate, samplesPerBlock);
+#endif
+
+  dryTap.prepare(sampleRate);
+  outputTap.prepare(sampleRate);
+
+  // ✅ Prepare convolution reverb: it only ever sees reverbBlockSize at a
+  // time, so its partitions (and cost) don't depend on the host's blocks
   juce::dsp::ProcessSpec spec;
   spec.sampleRate = sampleRate;
-  spec.maximumBlockSize = samplesPerBlock;
+  spec.maximumBlockSize = reverbBlockSize;
   spec.numChannels = getTotalNumOutputChannels();
 
+  // ✅ Load user-selected IR from dropdown. This comes before prepare(), which
+  // then installs the IR synchronously instead of on a background thread.
+  loadSelectedImpulseResponse();  // 🪄 This is your new function that uses irChoice
+  refillSpareIRs();
+
   convolution.reset();
   convolution.prepare(spec);
 
-  // ✅ Load user-selected IR from dropdown
-  loadSelectedImpulseResponse();  // 🪄 This is your new function that uses irChoice
+  dryScratch.setSize(2, reverbBlockSize);
+  streamScratch.assign(static_cast<size_t>(microBlockSize), 0.0f);
+  streamResampler.prepare(microBlockSize);
+  resampledStream = nullptr;
+
+  // 🎸 Plucked strings: every delay line is allocated here, once
+  strings.prepare(static_cast<float>(sampleRate));
+  pluckScratch.assign(static_cast<size_t>(microBlockSize), 0.0f);
 
   // ✅ Reset synth
-  synth.setPentatonicChord(220.0f); // A2 pentatonic to start
-  chordChangeTimer = 0;
+  synth.prepare(sampleRate, reverbBlockSize);
+  for (auto* curve : {&sineMixCurve, &sawMixCurve, &triMixCurve, &pitchCurve, &cutoffCurve,
+                      &padGain})
+    curve->assign(static_cast<size_t>(reverbBlockSize), 0.0f);
+  padScratch.setSize(2, reverbBlockSize);
+  padOffset = padPending = 0;
+  padMuted = false;
+  setChord(Tuning::getRootFrequency(57)); // the selected scale on A3 to start
+  samplesSinceChordChange = 0;
+
+  drySilence.reset();
+  convolutionIdle = false;
+  updateTailLength();
+
+  resetRamps(sampleRate);
+  matrix.prepare(sampleRate);
 
 
   // initialisation that you need..
@@ -223,7 +380,7 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported(
 
 void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                              juce::MidiBuffer& midiMessages) {
-  juce::ignoreUnused(midiMessages);
+  KY_PROFILE_BLOCK(profiler, buffer.getNumSamples());
   juce::ScopedNoDenormals noDenormals;
 
   auto totalNumInputChannels = getTotalNumInputChannels();
@@ -232,21 +389,72 @@ void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
   for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
     buffer.clear(i, 0, buffer.getNumSamples());
 
-  
-  float gainValue = apvts.getParameter("gain")->getValue();
-  float freq = apvts.getParameter("frequency")->getValue();
-  float chordChangingRate = apvts.getParameter("chordRate")->getValue();
-  float sineMix = apvts.getParameter("sineMix")->getValue();
-  float sawMix = apvts.getParameter("sawMix")->getValue();
-  float triMix = apvts.getParameter("triMix")->getValue();
-  float cutoff = apvts.getParameter("cutoff")->getValue();
-  float lfoDepth = *apvts.getRawParameterValue("lfoDepth");
-  float reverbMix = apvts.getParameter("reverbMix")->getValue();
-
-
-  synth.setMixingRatios(sineMix, sawMix, triMix);
-  synth.setFilterCutoff(cutoff * 9500 + 500);
-  synth.setLfoDepth(lfoDepth * 0.05);
+  // 🎛️ A recalled program lands here, then the ramps below take the DSP to
+  // its values and the convolution crossfades to its IR
+  presets.applyPending();
+  switchImpulseResponse();
+
+  // 🧱 Whatever the host's block size, the work is done in the same fixed
+  // slices: micro-blocks through the strings and stream, then the pad and
+  // the reverb over the chunk they make up
+  const int numSamples = buffer.getNumSamples();
+  auto midiEvent = midiMessages.cbegin();
+  for (int start = 0; start < numSamples;) {
+    int count = juce::jmin(reverbBlockSize, numSamples - start);
+    for (int micro = start; micro < start + count; micro += microBlockSize)
+      renderMicroBlock(buffer, micro, juce::jmin(microBlockSize, start + count - micro),
+                       midiMessages, midiEvent);
+    renderPad(buffer);
+    dryTap.push(buffer, start, count);
+    applyReverb(buffer, start, count);
+    start += count;
+  }
+
+  updateTailLength();  // the IR may have changed, or finished loading
+}
+
+// One micro-block of the strings and stream, in place at `offset` in the
+// host's buffer, and the pad's curves for it. Every parameter and the mod
+// matrix are read afresh here.
+void AudioPluginAudioProcessor::renderMicroBlock(juce::AudioBuffer<float>& buffer, int offset,
+                                                 int numSamples,
+                                                 const juce::MidiBuffer& midiMessages,
+                                                 juce::MidiBufferIterator& midiEvent) {
+  // 🌀 Modulation matrix. Slot 0 is the pad's vibrato: LFO 1 to detune, as
+  // deep as lfoDepth. The others are routed by the mod parameters; detune
+  // amounts are scaled so that full depth is ±5%, like the vibrato.
+  matrix.setControlInterval(16 << static_cast<int>(*live.controlRate));
+  matrix.setLfoRate(0, *live.lfoRate);
+  matrix.setLfoRate(1, *live.lfo2Rate);
+  matrix.setEnvelope(*live.envAttack, *live.envDecay);
+  matrix.setRandomRate(*live.walkRate);
+  matrix.setSlot(0, ModMatrix::lfo1, ModMatrix::detune, *live.lfoDepth * 0.05f);
+  for (int slot = 1; slot < ModMatrix::numSlots; ++slot) {
+    const auto& p = modSlots[static_cast<size_t>(slot - 1)];
+    int destination = static_cast<int>(*p.destination);
+    float range = destination == ModMatrix::detune ? 0.05f : 1.0f;
+    matrix.setSlot(slot, static_cast<int>(*p.source) - 1, destination, *p.amount * range);
+  }
+
+  // gain and reverb mix take their modulation here, through the ramps;
+  // everything else is modulated per sample as the pad renders
+  gainRamp.next(juce::jlimit(0.0f, 1.0f, gainRamp.parameter->getValue() +
+                                             matrix.getCurrent(ModMatrix::gain)),
+                numSamples);
+  for (auto* ramp : {&sineMixRamp, &sawMixRamp, &triMixRamp, &cutoffRamp, &pluckMixRamp})
+    ramp->next(ramp->parameter->getValue(), numSamples);
+
+  float freq = live.frequency->getValue();
+  float chordChangingRate = live.chordRate->getValue();
+  int progression = static_cast<int>(*live.progression);
+
+
+  // 💤 At the bottom of the gain range the pad and the plucks are far below
+  // audibility, so they are not rendered at all; ringing strings are stopped
+  // rather than left to resume stale when the gain comes back up
+  const bool muted = gainRamp.start < silentGain && gainRamp.end < silentGain;
+  if (muted && !strings.isSilent()) strings.silence();
+
   
 
   // auto thing = this->buffer.exchange(nullptr, std::memory_order_acq_rel);
@@ -255,82 +463,307 @@ void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
   //timer.frequency(7 * r);
   // ramp.frequency(0.3f);
 
-  // 🎚️ Get user-defined chord change rate from slider
+  // 🎚️ Get user-defined chord change rate from slider (3 to 9 seconds)
   chordChangeInterval = chordChangingRate + 0.5; 
-  //std::cout << "Chord Change Interval: " << chordChangeInterval << " seconds" << std::endl;
+  auto chordIntervalSamples = juce::jmax<juce::int64>(
+      1, static_cast<juce::int64>(chordChangeInterval * 6.0 * getSampleRate()));
 
-  // 🎵 Chord Progression Logic: Switch chords automatically
-  chordChangeTimer += (buffer.getNumSamples() / getSampleRate()) / 6.0f;
-  //std::cout << "Chord Change Interval: " << chordChangeInterval << " seconds" << std::endl;
-  
+  // ✅ Keep existing sample buffers; the layers all add to them, the pad last
+  buffer.clear(offset, numSamples);
+  auto* leftChannel = buffer.getWritePointer(0, offset);
+  auto* rightChannel = buffer.getWritePointer(1, offset);
   
-  if (chordChangeTimer >= chordChangeInterval) {
-      chordChangeTimer = 0; // Reset timer
-      currentChordIndex = (currentChordIndex + 1) % 4; // Cycle through 4 chords
-
-      // Set the new chord based on index
-      if (currentChordIndex == 0) {
-          synth.setPentatonicChord(110.0f * (0.75 + 0.5 * freq)); // A2 pentatonic
-      } else if (currentChordIndex == 1) {
-          synth.setPentatonicChord(82.4f * (0.75 + 0.5 * freq)); // E2 pentatonic
-      } else if (currentChordIndex == 2) {
-          synth.setPentatonicChord(73.4f * (0.75 + 0.5 * freq)); // D2 pentatonic
-      } else {
-          synth.setPentatonicChord(98.0f * (0.75 + 0.5 * freq)); // G2 pentatonic
+  // 🎸 Plucked-string layer: chord changes and MIDI note-ons pluck
+  int pluckScratchSize = static_cast<int>(pluckScratch.size());
+  auto renderStrings = [&](int start, int end) {
+    if (strings.isSilent()) return;  // nothing ringing: it would add zeros
+    while (start < end && pluckScratchSize > 0) {
+      int count = juce::jmin(pluckScratchSize, end - start);
+      strings.process(pluckScratch.data(), count);
+      for (int i = 0; i < count; ++i) {
+        float sample = pluckScratch[static_cast<size_t>(i)] *
+                       pluckMixRamp.at(start + i) * gainRamp.at(start + i);
+        leftChannel[start + i] += sample;
+        rightChannel[start + i] += sample;
       }
-  }
-
+      start += count;
+    }
+  };
+
+  // 🎵 Chord Progression Logic: the block is rendered in segments that end
+  // exactly where a chord change falls, so changes land on the same sample
+  // whatever block size the host uses
+  for (int start = 0; start < numSamples;) {
+    auto untilChange = juce::jmax<juce::int64>(
+        0, chordIntervalSamples - samplesSinceChordChange);
+    int end = static_cast<int>(juce::jmin<juce::int64>(numSamples, start + untilChange));
+
+    // a muted stretch of the pad is not rendered at all
+    if (muted != padMuted) {
+      renderPad(buffer);
+      padMuted = muted;
+    }
+    if (padPending == 0) padOffset = offset + start;
+
+    {
+      KY_PROFILE_STAGE(profiler, synth);
+
+      // the matrix's control-rate lines are written out per sample, after
+      // those of the micro-blocks before in the chunk, for renderPad(): the
+      // mix ratios and pitch follow the lines per sample, the filter glides
+      // along the cutoff line
+      const int count = end - start;
+      for (int k = 0; k < count;) {
+        int span = matrix.next(count - k);
+        if (!muted) {
+          auto at = [this](float value, ModMatrix::Destination d, int n) {
+            return juce::jlimit(0.0f, 1.0f, value + matrix.get(d, n));
+          };
+          for (int n = 0; n < span; ++n) {
+            auto s = static_cast<size_t>(padPending + k + n);
+            int i = start + k + n;  // into the micro-block, where the ramps count from
+            sineMixCurve[s] = at(sineMixRamp.at(i), ModMatrix::sineMix, n);
+            sawMixCurve[s] = at(sawMixRamp.at(i), ModMatrix::sawMix, n);
+            triMixCurve[s] = at(triMixRamp.at(i), ModMatrix::triMix, n);
+            pitchCurve[s] = matrix.get(ModMatrix::detune, n);
+            cutoffCurve[s] = at(cutoffRamp.at(i), ModMatrix::cutoff, n) * 9500 + 500;
+            padGain[s] = gainRamp.at(i);  // ✅ volume control
+          }
+        }
+        k += span;
+      }
+      padPending += count;
+    }
 
-  // ✅ Keep existing sample buffers
-  auto* leftChannel = buffer.getWritePointer(0);
-  auto* rightChannel = buffer.getWritePointer(1);
-  
-  for (int i = 0; i < buffer.getNumSamples(); ++i) {
+    {
+      KY_PROFILE_STAGE(profiler, strings);
+      int position = start;
+      for (; midiEvent != midiMessages.cend(); ++midiEvent) {
+        const auto metadata = *midiEvent;
+        int eventPosition =
+            juce::jlimit(0, buffer.getNumSamples(), metadata.samplePosition) - offset;
+        if (eventPosition >= end) break;
+        auto message = metadata.getMessage();
+        if (!message.isNoteOn() || muted) continue;
+        renderStrings(position, eventPosition);
+        position = juce::jmax(position, eventPosition);
+        strings.pluck(ky::mtof(static_cast<float>(message.getNoteNumber())),
+                      message.getFloatVelocity());
+      }
+      renderStrings(position, end);
+    }
 
-    float sample = synth.process(getSampleRate());
-    // ✅ Apply gain (volume control)
-    
-    // sample *= v; 
-    sample *= gainValue; 
+    samplesSinceChordChange += end - start;
+    if (samplesSinceChordChange >= chordIntervalSamples) {
+      samplesSinceChordChange = 0;
+      renderPad(buffer);  // the old chord up to here
+      advanceChord(freq, progression);
+    }
+    start = end;
+  }
 
-    // ✅ Send to Left & Right Channels
-    leftChannel[i] = sample;
-    rightChannel[i] = sample;
+  // 🎞️ Layer the streamed sample file (if any) on top of the pad, at the
+  // host's rate and (with a key set) transposed to the chord. If the message
+  // thread is swapping streams right now, skip it for this block.
+  {
+    KY_PROFILE_STAGE(profiler, stream);
+    const juce::SpinLock::ScopedTryLockType lock(streamLock);
+    if (lock.isLocked() && stream != nullptr && !streamScratch.empty()) {
+      if (resampledStream != stream.get()) {
+        streamResampler.reset();
+        resampledStream = stream.get();
+      }
+      int taps = 4 << static_cast<int>(*live.clipTaps);
+      if (taps != streamResampler.getTaps()) streamResampler.setTaps(taps);
+      int key = static_cast<int>(*live.clipKey);
+      if (key != clipPitchKey) updateClipPitch(key);
+      double increment = stream->getSampleRate() / getSampleRate() * clipPitch;
+      auto read = [this](float* destination, int count) { stream->read(destination, count); };
+
+      int scratchSize = static_cast<int>(streamScratch.size());
+      for (int start = 0; start < numSamples; start += scratchSize) {
+        int count = juce::jmin(scratchSize, numSamples - start);
+        streamResampler.process(streamScratch.data(), count, increment, read);
+        for (int i = 0; i < count; ++i) {
+          float sample = streamScratch[static_cast<size_t>(i)] * gainRamp.at(start + i);
+          leftChannel[start + i] += sample;
+          rightChannel[start + i] += sample;
+        }
+      }
+    }
   }
+}
 
-  // Store dry buffer first (before reverb)
-  juce::AudioBuffer<float> dryBuffer;
-  dryBuffer.makeCopyOf(buffer);
+// The pad over the samples whose curves renderMicroBlock() has written since
+// the last call, added to the host's buffer at padOffset. It renders in one
+// go (on several cores when the chord is big), so it is called only where it
+// has to be: at a chord change, when the pad mutes or unmutes, and at the end
+// of every chunk.
+void AudioPluginAudioProcessor::renderPad(juce::AudioBuffer<float>& buffer) {
+  const int count = padPending;
+  padOffset += count;
+  padPending = 0;
+  if (count == 0 || padMuted) return;
+
+  KY_PROFILE_STAGE(profiler, synth);
+  synth.setFilterResonance(*live.resonance, microBlockSize);
+  synth.setUnison(static_cast<int>(*live.unison), *live.unisonSpread, *live.stereoWidth);
+  synth.setPanning(*live.panSpread, *live.panMotion);
+  AdditiveSynth::Controls controls;
+  controls.sineMix = sineMixCurve.data();
+  controls.sawMix = sawMixCurve.data();
+  controls.triMix = triMixCurve.data();
+  controls.pitch = pitchCurve.data();
+  controls.cutoff = cutoffCurve.data();
+  synth.render(padScratch.getWritePointer(0), padScratch.getWritePointer(1), count, controls);
+
+  for (int channel = 0; channel < 2; ++channel)
+    juce::FloatVectorOperations::addWithMultiply(buffer.getWritePointer(channel, padOffset - count),
+                                                 padScratch.getReadPointer(channel),
+                                                 padGain.data(), count);
+}
 
-  // ✅ Keep Convolution Reverb (if active)
-  juce::dsp::AudioBlock<float> block(buffer);
-  juce::dsp::ProcessContextReplacing<float> context(block);
-  convolution.process(context);
+// The reverb and the dry/wet mix over one chunk of finished micro-blocks
+void AudioPluginAudioProcessor::applyReverb(juce::AudioBuffer<float>& buffer, int offset,
+                                            int numSamples) {
+  reverbMixRamp.next(juce::jlimit(0.0f, 1.0f, reverbMixRamp.parameter->getValue() +
+                                                  matrix.getCurrent(ModMatrix::reverbMix)),
+                     numSamples);
+
+  // 💤 Once the reverb's input has been quiet for longer than the IR, its
+  // output is silent too: skip the convolution and clear its history, so it
+  // picks up cleanly (from silence, as it would have) when sound returns
+  const float* channels[] = {buffer.getReadPointer(0, offset), buffer.getReadPointer(1, offset)};
+  drySilence.setHold(convolution.getCurrentIRSize());
+  if (drySilence.update(channels, 2, numSamples)) {
+    if (!convolutionIdle) {
+      convolution.reset();
+      convolutionIdle = true;
+    }
+    KY_PROFILE_STAGE(profiler, mix);
+    buffer.applyGainRamp(offset, numSamples, 1.0f - reverbMixRamp.start, 1.0f - reverbMixRamp.end);
+    outputTap.push(buffer, offset, numSamples);
+    return;
+  }
+  convolutionIdle = false;
+
+  // Store dry buffer first (before reverb), in the scratch made in prepareToPlay
+  {
+    KY_PROFILE_STAGE(profiler, convolution);
+    for (int channel = 0; channel < 2; ++channel)
+      dryScratch.copyFrom(channel, 0, buffer, channel, offset, numSamples);
+
+    // ✅ Keep Convolution Reverb (if active)
+    auto block = juce::dsp::AudioBlock<float>(buffer).getSubBlock(
+        static_cast<size_t>(offset), static_cast<size_t>(numSamples));
+    juce::dsp::ProcessContextReplacing<float> context(block);
+    convolution.process(context);
+  }
 
   // Now blend dry and wet buffers
-  for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
-    float* wet = buffer.getWritePointer(channel);
-    float* dry = dryBuffer.getWritePointer(channel);
-    for (int i = 0; i < buffer.getNumSamples(); ++i) {
-        wet[i] = (1.0f - reverbMix) * dry[i] + reverbMix * wet[i];
-    }
+  KY_PROFILE_STAGE(profiler, mix);
+  for (int channel = 0; channel < 2; ++channel)
+    ky::kernels().crossfade(dryScratch.getReadPointer(channel),
+                            buffer.getWritePointer(channel, offset), reverbMixRamp.start,
+                            reverbMixRamp.step, numSamples);
+  outputTap.push(buffer, offset, numSamples);
+}
+
+void AudioPluginAudioProcessor::updateTailLength() {
+  double irSeconds = getSampleRate() > 0
+                         ? convolution.getCurrentIRSize() / getSampleRate()
+                         : 0.0;
+  tailSeconds.store(strings.getDecay() + irSeconds, std::memory_order_relaxed);
+}
+
+bool AudioPluginAudioProcessor::openSampleFile(const juce::File& file) {
+  if (!streamThread.isThreadRunning()) streamThread.startThread();
+
+  auto next = SampleStream::open(file, streamThread);
+  if (next == nullptr) return false;
+
+  {
+    const juce::SpinLock::ScopedLockType lock(streamLock);
+    std::swap(stream, next);
   }
+
+  // `next` now holds the old stream, which is destroyed here
+  return true;
+}
+
+void AudioPluginAudioProcessor::advanceChord(float freq, int progression) {
+  const auto& roots = PresetBank::getProgressions()[static_cast<size_t>(
+      juce::jlimit(0, static_cast<int>(PresetBank::getProgressions().size()) - 1, progression))].roots;
+  currentChordIndex = (currentChordIndex + 1) % static_cast<int>(roots.size()); // Cycle through the chords
+
+  // Set the new chord based on index (the selected scale on each root)
+  float root = Tuning::getRootFrequency(roots[static_cast<size_t>(currentChordIndex)]);
+  setChord(root * (0.75f + 0.5f * freq));
+  pluckChord();
+  matrix.trigger();
 }
 
-void AudioPluginAudioProcessor::setBuffer(
-    std::unique_ptr<juce::AudioBuffer<float>> buffer) {
-  juce::ignoreUnused(buffer);
+// clipPitch becomes the ratio that takes a sample in `key` (1 = C) to the
+// nearest octave of the chord's root, so it moves by at most a tritone; 1 if
+// the key is Off
+void AudioPluginAudioProcessor::updateClipPitch(int key) {
+  clipPitchKey = key;
+  clipPitch = 1.0;
+  if (key <= 0 || chordRoot <= 0) return;
+  double semitones = 12.0 * std::log2(static_cast<double>(chordRoot) /
+                                      Tuning::getRootFrequency(59 + key));
+  semitones -= 12.0 * std::round(semitones / 12.0);
+  clipPitch = std::exp2(semitones / 12.0);
+}
 
-  auto b = std::make_unique<ky::ClipPlayer>();
-  for (int i = 0; i < buffer->getNumSamples(); ++i) {
-    if (buffer->getNumChannels() == 2) {
-      b->addSample(buffer->getSample(0, i) / 2 + buffer->getSample(1, i) / 2);
-    } else {
-      b->addSample(buffer->getSample(0, i));
+void AudioPluginAudioProcessor::setChord(float root) {
+  chordRoot = root;
+  updateClipPitch(clipPitchKey);
+  int mode = static_cast<int>(*apvts.getRawParameterValue("scale"));
+  if (mode >= Tuning::numModes) {
+    // the custom scale, unless the message thread is replacing it right now:
+    // then the copy from the last chord is played again
+    const juce::SpinLock::ScopedTryLockType lock(scaleLock);
+    if (lock.isLocked()) playingScale = customScale;
+    if (playingScale.size > 0) {
+      synth.setChord(root, playingScale.ratios.data(), playingScale.size);
+      return;
     }
+    mode = Tuning::majorPentatonic;  // nothing loaded yet
   }
 
-  player = std::move(b);
+  const auto& scale =
+      Tuning::getScale(mode, static_cast<int>(*apvts.getRawParameterValue("temperament")));
+  synth.setChord(root, scale.ratios.data(), scale.size);
+}
+
+bool AudioPluginAudioProcessor::loadScalaFile(const juce::File& file) {
+  auto text = file.loadFileAsString().toStdString();
+  auto scale = Tuning::fromScala(text);
+  if (scale.size == 0) return false;
+
+  const juce::SpinLock::ScopedLockType lock(scaleLock);
+  customScale = scale;
+  return true;
+}
+
+void AudioPluginAudioProcessor::setRenderSeed(uint64_t seed) {
+  synth.setSeed(seed);
+  strings.seed(seed + 1);
+  matrix.seed(seed + 2);
+}
+
+void AudioPluginAudioProcessor::setAssetDirectory(const juce::File& directory) {
+  assetDirectory = directory;
+  lastLoadedIR = -1;
+  for (auto& spare : spareIRs) spare.ready = false;
+}
+
+void AudioPluginAudioProcessor::pluckChord() {
+  // an octave above the pad, so the plucks shimmer on top of it
+  for (int i = 0; i < synth.getNumHarmonics(); ++i) {
+    strings.pluck(2.0f * synth.getHarmonicFrequency(i), 0.5f);
+  }
 }
 
 bool AudioPluginAudioProcessor::hasEditor() const {
@@ -343,19 +776,12 @@ juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor() {
 
 void AudioPluginAudioProcessor::getStateInformation(
     juce::MemoryBlock& destData) {
-  auto state = apvts.copyState();
-  std::unique_ptr<juce::XmlElement> xml(state.createXml());
-  copyXmlToBinary(*xml, destData);
+  presets.write(destData);
 }
 
 void AudioPluginAudioProcessor::setStateInformation(const void* data,
                                                     int sizeInBytes) {
-  std::unique_ptr<juce::XmlElement> xmlState(
-      getXmlFromBinary(data, sizeInBytes));
-
-  if (xmlState.get() != nullptr)
-    if (xmlState->hasTagName(apvts.state.getType()))
-      apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+  presets.read(data, sizeInBytes);
 }
 
 void AudioPluginAudioProcessor::loadSelectedImpulseResponse() {
@@ -364,21 +790,16 @@ void AudioPluginAudioProcessor::loadSelectedImpulseResponse() {
   if (selectedIR == lastLoadedIR)
       return;  // Skip if already loaded
 
-  juce::File irFile;
-  auto desktop = juce::File::getSpecialLocation(juce::File::userDesktopDirectory);
-
-  if (selectedIR == 0)
-      irFile = desktop.getChildFile("church_ir.wav");
-  else if (selectedIR == 0.5)
-      irFile = desktop.getChildFile("cave_ir.wav");
-  else if (selectedIR == 1)
-      irFile = desktop.getChildFile("room_ir.wav");
+  juce::File irFile = impulseResponseFile(selectedIR);
 
-  if (irFile.existsAsFile()) {
-      convolution.loadImpulseResponse(irFile,
+  // decoded once per process, whichever instance asks first
+  auto ir = irFile.existsAsFile() ? assets->getImpulseResponse(irFile) : nullptr;
+  if (ir != nullptr) {
+      convolution.loadImpulseResponse(juce::AudioBuffer<float>(ir->audio),
+          ir->sampleRate,
           juce::dsp::Convolution::Stereo::yes,
           juce::dsp::Convolution::Trim::no,
-          0);
+          juce::dsp::Convolution::Normalise::yes);
       lastLoadedIR = selectedIR;
       std::cout << "Loaded IR: " << irFile.getFileName() << std::endl;
   } else {
@@ -386,6 +807,53 @@ void AudioPluginAudioProcessor::loadSelectedImpulseResponse() {
   }
 }
 
+juce::File AudioPluginAudioProcessor::impulseResponseFile(int irChoice) const {
+  // irChoice's raw value is the choice index
+  const char* names[] = {"church_ir.wav", "cave_ir.wav", "room_ir.wav"};
+  if (!juce::isPositiveAndBelow(irChoice, 3)) return {};
+  return assetDirectory.getChildFile(names[irChoice]);
+}
+
+// message thread: replace the spares the audio thread has used up
+void AudioPluginAudioProcessor::refillSpareIRs() {
+  for (int i = 0; i < static_cast<int>(spareIRs.size()); ++i) {
+    auto& spare = spareIRs[static_cast<size_t>(i)];
+    if (spare.ready.load(std::memory_order_acquire)) continue;
+
+    auto file = impulseResponseFile(i);
+    auto ir = file.existsAsFile() ? assets->getImpulseResponse(file) : nullptr;
+    if (ir == nullptr) continue;
+
+    spare.audio.makeCopyOf(ir->audio);
+    spare.sampleRate = ir->sampleRate;
+    spare.ready.store(true, std::memory_order_release);
+  }
+}
+
+// audio thread: if irChoice has moved, hand the convolution the spare copy of
+// the new IR. The buffer is moved into the convolution's loader queue (and
+// freed on its thread); the engine is built there and crossfaded in.
+void AudioPluginAudioProcessor::switchImpulseResponse() {
+  int selectedIR = static_cast<int>(*apvts.getRawParameterValue("irChoice"));
+  if (selectedIR == lastLoadedIR || !juce::isPositiveAndBelow(selectedIR, 3)) return;
+
+  auto& spare = spareIRs[static_cast<size_t>(selectedIR)];
+  if (!spare.ready.load(std::memory_order_acquire)) return;  // try next block
+
+  convolution.loadImpulseResponse(std::move(spare.audio), spare.sampleRate,
+                                  juce::dsp::Convolution::Stereo::yes,
+                                  juce::dsp::Convolution::Trim::no,
+                                  juce::dsp::Convolution::Normalise::yes);
+  spare.ready.store(false, std::memory_order_release);
+  lastLoadedIR = selectedIR;
+  triggerAsyncUpdate();
+}
+
+void AudioPluginAudioProcessor::resetRamps(double sampleRate) {
+  for (auto* ramp : {&gainRamp, &sineMixRamp, &sawMixRamp, &triMixRamp, &cutoffRamp,
+                     &reverbMixRamp, &pluckMixRamp})
+    ramp->reset(sampleRate, ramp->parameter->getValue());
+}
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter() {
   return new AudioPluginAudioProcessor();
@@ -3,11 +3,20 @@
 #include <JuceHeader.h>
 
 #include "AdditiveSynth.h"
+#include "AnalysisTap.h"
 #include "Library.h"
+#include "ModMatrix.h"
+#include "PresetBank.h"
+#include "Profiler.h"
+#include "SampleStream.h"
+#include "SharedAssets.h"
+#include "StringBank.h"
+#include "Tuning.h"
 
 
 //==============================================================================
-class AudioPluginAudioProcessor final : public juce::AudioProcessor {
+class AudioPluginAudioProcessor final : public juce::AudioProcessor,
+                                        private juce::AsyncUpdater {
  public:
   //==============================================================================
   AudioPluginAudioProcessor();
@@ -45,7 +54,32 @@ class AudioPluginAudioProcessor final : public juce::AudioProcessor {
   void getStateInformation(juce::MemoryBlock& destData) override;
   void setStateInformation(const void* data, int sizeInBytes) override;
 
-  void setBuffer(std::unique_ptr<juce::AudioBuffer<float>> buffer);
+  // message thread: start streaming a sample file; the previous one (if any)
+  // is released here, never on the audio thread
+  bool openSampleFile(const juce::File& file);
+
+  // message thread: read a Scala (.scl) scale for the "Custom" scale choice.
+  // False, leaving the current one, if the file is not a valid scale.
+  bool loadScalaFile(const juce::File& file);
+
+  // For reproducible renders: reseed every random source (detune, pluck
+  // noise). Call before prepareToPlay().
+  void setRenderSeed(uint64_t seed);
+
+  // Where the IR files live; the Desktop unless set. Call before prepareToPlay().
+  void setAssetDirectory(const juce::File& directory);
+
+  // Length of the IR the convolution is using right now (1 until one is in)
+  int getImpulseResponseSize() const { return convolution.getCurrentIRSize(); }
+
+#if KY_ENABLE_PROFILER
+  Profiler& getProfiler() { return profiler; }
+#endif
+
+  // What the editor's analyser watches: the mix going into the reverb, and
+  // the final output
+  AnalysisTap& getDryTap() { return dryTap; }
+  AnalysisTap& getOutputTap() { return outputTap; }
 
   juce::AudioProcessorValueTreeState apvts;
   // std::atomic<juce::AudioBuffer<float>*> buffer;
@@ -56,16 +90,141 @@ class AudioPluginAudioProcessor final : public juce::AudioProcessor {
   ky::SchroederReverb reverb, reverb2;
   ky::AttackDecay env;
 
-  std::unique_ptr<ky::ClipPlayer> player;
-  juce::dsp::Convolution convolution;
+  juce::TimeSliceThread streamThread{"Sample Stream"};
+  std::unique_ptr<SampleStream> stream;
+  juce::SpinLock streamLock;
+  std::vector<float> streamScratch;
+  ky::Resampler streamResampler;  // the stream to the host's rate and the chord
+  const SampleStream* resampledStream = nullptr;  // whose history it holds
+  // the stream's transposition for clipKey, worked out only when the key or
+  // the chord changes
+  void updateClipPitch(int key);
+  int clipPitchKey = 0;
+  double clipPitch = 1.0;
+
+  // IRs and the convolution's loader thread are shared with every other
+  // instance; the convolution itself (partitions and history) is per instance
+  juce::SharedResourcePointer<SharedAssets> assets;
+  juce::dsp::Convolution convolution{juce::dsp::Convolution::Latency{0},
+                                     assets->getConvolutionQueue()};
+
+#if KY_ENABLE_PROFILER
+  Profiler profiler;
+#endif
+
+  AnalysisTap dryTap, outputTap;
+
+  // 💤 Idle detection: below silentGain nothing is rendered, and the
+  // convolution sleeps once its input has been silent for longer than the IR
+  static constexpr float silentGain = 1e-4f;  // -80 dB
+  ky::SilenceDetector drySilence;
+  bool convolutionIdle = false;
+  std::atomic<double> tailSeconds{0};
+  void updateTailLength();
 
   void loadSelectedImpulseResponse();
   int lastLoadedIR = -1;
-  
+  juce::File assetDirectory =
+      juce::File::getSpecialLocation(juce::File::userDesktopDirectory);
+  juce::File impulseResponseFile(int irChoice) const;
+
+  // 🔁 A ready-made copy of each IR for the audio thread to hand to the
+  // convolution (which crossfades to it) when irChoice changes, so switching
+  // never allocates there. The message thread makes a new copy afterwards.
+  struct SpareIR {
+    juce::AudioBuffer<float> audio;
+    double sampleRate = 0;
+    std::atomic<bool> ready{false};  // audio thread owns `audio` while set
+  };
+  std::array<SpareIR, 3> spareIRs;
+  void refillSpareIRs();
+  void switchImpulseResponse();
+  void handleAsyncUpdate() override { refillSpareIRs(); }
+
+  // 🎛️ Programs: requested from any thread, applied at the top of a block
+  PresetBank presets{apvts};
+
+  // 🧱 Host blocks are worked through in micro-blocks of microBlockSize
+  // samples, each taken through the strings and stream while it is still in
+  // L1, with the parameters and the mod matrix read at every one. The pad's
+  // control curves are written out at every micro-block too, but the pad
+  // itself renders up to reverbBlockSize samples in one go (split only at
+  // chord changes and mutes), so a big chord gives the render pool enough
+  // work to spread. The reverb then runs over the same chunk. Neither size
+  // depends on the host's, so neither does the cost per sample, and blocks
+  // past the prepared size are fine.
+  static constexpr int microBlockSize = 64;
+  static constexpr int reverbBlockSize = 512;
+  void renderMicroBlock(juce::AudioBuffer<float>& buffer, int offset, int numSamples,
+                        const juce::MidiBuffer& midiMessages, juce::MidiBufferIterator& midiEvent);
+  void renderPad(juce::AudioBuffer<float>& buffer);
+  void applyReverb(juce::AudioBuffer<float>& buffer, int offset, int numSamples);
+  juce::AudioBuffer<float> dryScratch;  // the reverb's input, for the mix
+
+  // the parameters read at every micro-block, looked up once
+  struct LiveParameters {
+    std::atomic<float> *controlRate, *lfoRate, *lfo2Rate, *envAttack, *envDecay, *walkRate,
+        *lfoDepth, *resonance, *unison, *unisonSpread, *stereoWidth, *panSpread, *panMotion,
+        *progression, *clipKey, *clipTaps;
+    juce::RangedAudioParameter *frequency, *chordRate;
+  };
+  LiveParameters live{};
+
+  // 🎚️ Every continuous parameter reaches the DSP through a short linear
+  // ramp, so neither automation nor a program change steps. Over a
+  // micro-block the value goes from `start` to `end`; at(i) is the value at
+  // sample i.
+  struct ParameterRamp {
+    juce::RangedAudioParameter* parameter = nullptr;  // normalised value
+    juce::SmoothedValue<float> smoothed;
+    float start = 0, end = 0, step = 0;
+
+    void reset(double sampleRate, float value) {
+      smoothed.reset(sampleRate, 0.03);
+      smoothed.setCurrentAndTargetValue(value);
+      start = end = value;
+      step = 0;
+    }
+    void next(float target, int numSamples) {
+      start = smoothed.getCurrentValue();
+      smoothed.setTargetValue(target);
+      smoothed.skip(numSamples);
+      end = smoothed.getCurrentValue();
+      step = numSamples > 0 ? (end - start) / static_cast<float>(numSamples) : 0.0f;
+    }
+    float at(int i) const { return start + step * static_cast<float>(i); }
+  };
+  ModMatrix matrix;
+  struct ModSlotParameters {
+    std::atomic<float>* source;
+    std::atomic<float>* destination;
+    std::atomic<float>* amount;
+  };
+  std::array<ModSlotParameters, ModMatrix::numSlots - 1> modSlots{};
+
+  ParameterRamp gainRamp, sineMixRamp, sawMixRamp, triMixRamp, cutoffRamp,
+      reverbMixRamp, pluckMixRamp;
+  void resetRamps(double sampleRate);
+
 
   AdditiveSynth synth;
+  // the matrix's lines and the gain for the pad not yet rendered, sample by
+  // sample: padPending samples of them, from padOffset in the host's buffer
+  std::vector<float> sineMixCurve, sawMixCurve, triMixCurve, pitchCurve, cutoffCurve, padGain;
+  juce::AudioBuffer<float> padScratch;
+  int padOffset = 0, padPending = 0;
+  bool padMuted = false;
+  StringBank strings;
+  std::vector<float> pluckScratch;
+  void pluckChord();
+  void advanceChord(float freq, int progression);
+  void setChord(float root);  // the selected scale on `root` Hz
+  float chordRoot = 0;        // Hz, of the chord playing
+  juce::SpinLock scaleLock;
+  Tuning::Scale customScale;   // guarded by scaleLock
+  Tuning::Scale playingScale;  // the audio thread's copy
   int currentChordIndex = 0;  // Keeps track of which chord is playing
-  float chordChangeTimer = 0; // Timer to track when to switch chords
+  juce::int64 samplesSinceChordChange = 0; // When to switch chords
   float chordChangeInterval = 5.0f; // Default: Change every 5 seconds
 
   //==============================================================================
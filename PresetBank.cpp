@@ -0,0 +1,158 @@
+#include "PresetBank.h"
+
+#include "Tuning.h"
+
+namespace {
+
+struct Value {
+  const char* id;
+  float value;  // plain, not normalised
+};
+
+struct Preset {
+  const char* name;
+  std::vector<Value> values;  // parameters not listed take their defaults
+};
+
+// irChoice: 0 church, 1 cave, 2 room. progression: see getProgressions().
+// scale and temperament: see Tuning
+const std::vector<Preset>& factoryPresets() {
+  static const std::vector<Preset> presets{
+      {"Init", {{"gain", -12.0f}}},
+      {"Cathedral Pad",
+       {{"gain", -12.0f}, {"chordRate", 7.0f}, {"sineMix", 0.5f}, {"sawMix", 0.2f},
+        {"triMix", 0.3f}, {"cutoff", 1800.0f}, {"lfoDepth", 0.2f}, {"reverbMix", 0.7f},
+        {"pluckMix", 0.1f}, {"irChoice", 0}, {"progression", 0}, {"unison", 3},
+        {"unisonSpread", 8.0f}, {"panSpread", 0.7f}}},
+      {"Cave Drone",
+       {{"gain", -10.0f}, {"frequency", 0.85f}, {"chordRate", 9.0f}, {"sineMix", 0.7f},
+        {"sawMix", 0.1f}, {"triMix", 0.4f}, {"cutoff", 900.0f}, {"lfoDepth", 0.4f},
+        {"reverbMix", 0.8f}, {"pluckMix", 0.0f}, {"irChoice", 1}, {"progression", 2},
+        {"scale", Tuning::minorPentatonic}}},
+      {"Bright Room",
+       {{"gain", -14.0f}, {"frequency", 1.1f}, {"chordRate", 4.0f}, {"sineMix", 0.2f},
+        {"sawMix", 0.7f}, {"triMix", 0.2f}, {"cutoff", 6000.0f}, {"lfoDepth", 0.1f},
+        {"reverbMix", 0.35f}, {"pluckMix", 0.4f}, {"irChoice", 2}, {"progression", 1}}},
+      {"Glass Plucks",
+       {{"gain", -12.0f}, {"frequency", 1.2f}, {"chordRate", 3.0f}, {"sineMix", 0.3f},
+        {"sawMix", 0.1f}, {"triMix", 0.3f}, {"cutoff", 8000.0f}, {"lfoDepth", 0.05f},
+        {"reverbMix", 0.5f}, {"pluckMix", 0.9f}, {"irChoice", 2}, {"progression", 3}}},
+      {"Slow Swell",
+       {{"gain", -16.0f}, {"chordRate", 9.0f}, {"sineMix", 0.4f}, {"sawMix", 0.4f},
+        {"triMix", 0.4f}, {"cutoff", 1200.0f}, {"lfoDepth", 0.6f}, {"reverbMix", 0.6f},
+        {"pluckMix", 0.2f}, {"irChoice", 0}, {"progression", 0}, {"unison", 6},
+        {"unisonSpread", 18.0f}, {"stereoWidth", 1.0f}, {"panMotion", 0.05f}}},
+      {"Dark Strings",
+       {{"gain", -10.0f}, {"frequency", 0.8f}, {"chordRate", 6.0f}, {"sineMix", 0.1f},
+        {"sawMix", 0.8f}, {"triMix", 0.1f}, {"cutoff", 600.0f}, {"lfoDepth", 0.3f},
+        {"reverbMix", 0.5f}, {"pluckMix", 0.6f}, {"irChoice", 1}, {"progression", 1},
+        {"scale", Tuning::aeolian}, {"temperament", Tuning::equal}}},
+  };
+  return presets;
+}
+
+}  // namespace
+
+const std::array<PresetBank::Progression, 4>& PresetBank::getProgressions() {
+  static const std::array<Progression, 4> progressions{{
+      {"A E D G", {45, 40, 38, 43}},
+      {"A F C G", {45, 41, 36, 43}},
+      {"E D A E", {40, 38, 45, 40}},
+      {"C G A F", {36, 43, 45, 41}},
+  }};
+  return progressions;
+}
+
+juce::StringArray PresetBank::getProgressionNames() {
+  juce::StringArray result;
+  for (const auto& p : getProgressions()) result.add(p.name);
+  return result;
+}
+
+PresetBank::PresetBank(juce::AudioProcessorValueTreeState& state) : apvts(state) {
+  for (auto* p : apvts.processor.getParameters())
+    if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(p))
+      parameters.push_back(ranged);
+
+  for (const auto& preset : factoryPresets()) {
+    std::vector<float> snapshot;
+    for (auto* p : parameters) snapshot.push_back(p->getDefaultValue());
+
+    for (const auto& v : preset.values) {
+      for (size_t i = 0; i < parameters.size(); ++i)
+        if (parameters[i]->getParameterID() == v.id)
+          snapshot[i] = parameters[i]->convertTo0to1(v.value);
+    }
+
+    names.push_back(preset.name);
+    snapshots.push_back(std::move(snapshot));
+  }
+}
+
+juce::String PresetBank::getName(int index) const {
+  return juce::isPositiveAndBelow(index, size()) ? names[static_cast<size_t>(index)]
+                                                  : juce::String();
+}
+
+void PresetBank::request(int index) {
+  if (juce::isPositiveAndBelow(index, size())) pending.store(index, std::memory_order_release);
+}
+
+bool PresetBank::applyPending() {
+  int index = pending.exchange(-1, std::memory_order_acquire);
+  if (index < 0) return false;
+
+  apply(snapshots[static_cast<size_t>(index)]);
+  current.store(index, std::memory_order_relaxed);
+  return true;
+}
+
+void PresetBank::apply(const std::vector<float>& snapshot) {
+  for (size_t i = 0; i < parameters.size(); ++i)
+    parameters[i]->setValueNotifyingHost(snapshot[i]);
+}
+
+void PresetBank::write(juce::MemoryBlock& destination) const {
+  juce::MemoryOutputStream out(destination, false);
+  out.writeInt(magic);
+  out.writeByte(static_cast<char>(version));
+  out.writeCompressedInt(getCurrent());
+  out.writeCompressedInt(static_cast<int>(parameters.size()));
+  for (auto* p : parameters) {
+    out.writeString(p->getParameterID());
+    out.writeFloat(p->convertFrom0to1(p->getValue()));
+  }
+}
+
+bool PresetBank::read(const void* data, int sizeInBytes) {
+  juce::MemoryInputStream in(data, static_cast<size_t>(sizeInBytes), false);
+
+  if (sizeInBytes < 5 || in.readInt() != magic) {
+    // not ours: XML from before the binary format
+    std::unique_ptr<juce::XmlElement> xml(
+        juce::AudioProcessor::getXmlFromBinary(data, sizeInBytes));
+    if (xml == nullptr || !xml->hasTagName(apvts.state.getType())) return false;
+    apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    return true;
+  }
+
+  // newer versions may only append to the record, so read what we know
+  if (in.readByte() < 1) return false;
+  int program = in.readCompressedInt();
+  int count = in.readCompressedInt();
+
+  // anything the record doesn't mention goes back to its default
+  std::vector<float> values;
+  for (auto* p : parameters) values.push_back(p->getDefaultValue());
+  for (int n = 0; n < count && !in.isExhausted(); ++n) {
+    auto id = in.readString();
+    float value = in.readFloat();
+    for (size_t i = 0; i < parameters.size(); ++i)
+      if (parameters[i]->getParameterID() == id)
+        values[i] = parameters[i]->convertTo0to1(value);
+  }
+
+  apply(values);
+  if (juce::isPositiveAndBelow(program, size())) current.store(program, std::memory_order_relaxed);
+  return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+// The factory programs, and the plugin state format.
+//
+// Every program is turned into a snapshot of normalised values for all the
+// parameters when the bank is built, so recalling one is a loop of stores:
+// setCurrentProgram() only records the request, and the audio thread applies
+// it at the top of the next block. The DSP reaches each parameter through a
+// short ramp, and a changed IR is crossfaded by the convolution, so a recall
+// never clicks.
+//
+// State is a small versioned binary record (parameter ID and plain value per
+// parameter, plus the program). XML written by older versions still loads.
+class PresetBank {
+ public:
+  // a chord progression: the root of each chord in turn, as a MIDI note
+  // (see Tuning::getRootFrequency())
+  struct Progression {
+    const char* name;
+    std::array<int, 4> roots;
+  };
+  static const std::array<Progression, 4>& getProgressions();
+  static juce::StringArray getProgressionNames();
+
+  explicit PresetBank(juce::AudioProcessorValueTreeState& state);
+
+  int size() const { return static_cast<int>(names.size()); }
+  juce::String getName(int index) const;
+  int getCurrent() const { return current.load(std::memory_order_relaxed); }
+
+  // any thread: recall a program at the next applyPending()
+  void request(int index);
+
+  // audio thread: set every parameter from the requested program's snapshot.
+  // Returns false if nothing was requested.
+  bool applyPending();
+
+  void write(juce::MemoryBlock& destination) const;
+  bool read(const void* data, int sizeInBytes);
+
+ private:
+  static constexpr int magic = 0x5350594b;  // "KYPS"
+  static constexpr int version = 1;
+
+  void apply(const std::vector<float>& snapshot);
+
+  juce::AudioProcessorValueTreeState& apvts;
+  std::vector<juce::RangedAudioParameter*> parameters;
+  std::vector<juce::String> names;
+  std::vector<std::vector<float>> snapshots;  // normalised, one per parameter
+  std::atomic<int> pending{-1};
+  std::atomic<int> current{0};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
@@ -0,0 +1,70 @@
+#include "Profiler.h"
+
+#if KY_ENABLE_PROFILER
+
+const char* Profiler::getStageName(int stage) {
+  switch (stage) {
+    case synth: return "synth";
+    case strings: return "strings";
+    case stream: return "stream";
+    case convolution: return "conv";
+    case mix: return "mix";
+    default: return "?";
+  }
+}
+
+void Profiler::prepare(double sampleRate, int maximumBlockSize) {
+  loadMeasurer.reset(sampleRate, maximumBlockSize);
+  samplerate = sampleRate;
+}
+
+Profiler::BlockScope::BlockScope(Profiler& p, int numSamples)
+    : profiler(p),
+      timer(p.loadMeasurer, numSamples),
+      start(juce::Time::getHighResolutionTicks()) {
+  profiler.current = Frame{};
+  profiler.current.numSamples = numSamples;
+}
+
+Profiler::BlockScope::~BlockScope() {
+  profiler.current.blockTicks = juce::Time::getHighResolutionTicks() - start;
+
+  // if the editor isn't draining, the ring fills up and frames are dropped
+  int start1, size1, start2, size2;
+  profiler.fifo.prepareToWrite(1, start1, size1, start2, size2);
+  if (size1 > 0) profiler.frames[static_cast<size_t>(start1)] = profiler.current;
+  profiler.fifo.finishedWrite(size1);
+}
+
+bool Profiler::drain(Report& report) {
+  int ready = fifo.getNumReady();
+  if (ready == 0) return false;
+
+  report = Report{};
+  double sampleRate = samplerate;
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(ready, start1, size1, start2, size2);
+
+  auto add = [&](const Frame& frame) {
+    if (frame.numSamples == 0) return;
+    double duration = frame.numSamples / sampleRate;
+    for (int s = 0; s < numStages; ++s) {
+      report.stageLoad[static_cast<size_t>(s)] +=
+          juce::Time::highResolutionTicksToSeconds(frame.stageTicks[static_cast<size_t>(s)]) /
+          duration;
+    }
+    report.peakBlockSeconds = juce::jmax(
+        report.peakBlockSeconds,
+        juce::Time::highResolutionTicksToSeconds(frame.blockTicks));
+  };
+  for (int i = 0; i < size1; ++i) add(frames[static_cast<size_t>(start1 + i)]);
+  for (int i = 0; i < size2; ++i) add(frames[static_cast<size_t>(start2 + i)]);
+  fifo.finishedRead(size1 + size2);
+
+  for (auto& load : report.stageLoad) load /= ready;
+  report.load = loadMeasurer.getLoadAsProportion();
+  report.xruns = loadMeasurer.getXRunCount();
+  return true;
+}
+
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+
+// Always-on timing of processBlock, split into stages. The audio thread reads
+// the high-resolution clock around each stage and pushes one frame per block
+// into a lock-free SPSC ring; the editor drains the ring on its timer. Build
+// with KY_ENABLE_PROFILER=0 to compile all of it out.
+#ifndef KY_ENABLE_PROFILER
+#define KY_ENABLE_PROFILER 1
+#endif
+
+#if KY_ENABLE_PROFILER
+
+class Profiler {
+ public:
+  enum Stage { synth, strings, stream, convolution, mix, numStages };
+  static const char* getStageName(int stage);
+
+  void prepare(double sampleRate, int maximumBlockSize);
+
+  // audio thread: brackets one processBlock call
+  class BlockScope {
+   public:
+    BlockScope(Profiler& p, int numSamples);
+    ~BlockScope();
+
+   private:
+    Profiler& profiler;
+    juce::AudioProcessLoadMeasurer::ScopedTimer timer;
+    juce::int64 start;
+  };
+
+  // audio thread: adds the time until the end of the scope to a stage
+  class StageScope {
+   public:
+    StageScope(Profiler& p, Stage s)
+        : profiler(p), stage(s), start(juce::Time::getHighResolutionTicks()) {}
+    ~StageScope() {
+      profiler.current.stageTicks[stage] +=
+          juce::Time::getHighResolutionTicks() - start;
+    }
+
+   private:
+    Profiler& profiler;
+    Stage stage;
+    juce::int64 start;
+  };
+
+  struct Report {
+    double load = 0;  // smoothed share of the block duration, all stages
+    std::array<double, numStages> stageLoad{};  // mean over the drained blocks
+    double peakBlockSeconds = 0;  // slowest drained block
+    int xruns = 0;
+  };
+
+  // message thread: summarise the blocks pushed since the last call. Returns
+  // false if there were none (the audio thread isn't running)
+  bool drain(Report& report);
+
+ private:
+  struct Frame {
+    std::array<juce::int64, numStages> stageTicks{};
+    juce::int64 blockTicks = 0;
+    int numSamples = 0;
+  };
+
+  static constexpr int capacity = 256;
+
+  juce::AudioProcessLoadMeasurer loadMeasurer;
+  std::atomic<double> samplerate{44100};
+  Frame current;  // audio thread only
+  juce::AbstractFifo fifo{capacity};
+  std::array<Frame, capacity> frames;
+};
+
+#define KY_PROFILE_CONCAT_(a, b) a##b
+#define KY_PROFILE_CONCAT(a, b) KY_PROFILE_CONCAT_(a, b)
+
+// time the enclosing processBlock; put this first
+#define KY_PROFILE_BLOCK(profiler, numSamples) \
+  Profiler::BlockScope KY_PROFILE_CONCAT(kyProfileBlock, __LINE__)(profiler, numSamples)
+
+// add the rest of the enclosing scope to a Profiler::Stage
+#define KY_PROFILE_STAGE(profiler, stage) \
+  Profiler::StageScope KY_PROFILE_CONCAT(kyProfileStage, __LINE__)(profiler, Profiler::stage)
+
+#else
+
+#define KY_PROFILE_BLOCK(profiler, numSamples)
+#define KY_PROFILE_STAGE(profiler, stage)
+
+#endif
@@ -0,0 +1,80 @@
+#include "RenderPool.h"
+
+#include <thread>
+
+RenderPool::RenderPool() {
+  int count = juce::jlimit(0, maxWorkers, juce::SystemStats::getNumCpus() - 1);
+  for (int i = 0; i < count; ++i) {
+    workers.push_back(std::make_unique<Worker>(*this));
+    // without the privileges for a real-time thread, the highest normal priority
+    if (!workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+      workers.back()->startThread(juce::Thread::Priority::highest);
+  }
+}
+
+RenderPool::~RenderPool() {
+  for (auto& worker : workers) worker->signalThreadShouldExit();
+  // a generation no job has: wakes every worker without giving it any work
+  published.fetch_add(1, std::memory_order_release);
+  published.notify_all();
+  for (auto& worker : workers) worker->stopThread(1000);
+}
+
+void RenderPool::Worker::run() {
+  uint32_t seen = pool.published.load(std::memory_order_acquire);
+  while (!threadShouldExit()) {
+    pool.published.wait(seen, std::memory_order_acquire);
+    uint32_t latest = pool.published.load(std::memory_order_acquire);
+    if (latest == seen) continue;
+    seen = latest;
+    pool.work(latest);
+  }
+}
+
+int RenderPool::claim(uint32_t jobGeneration) {
+  uint64_t current = ticket.load(std::memory_order_acquire);
+  for (;;) {
+    if (static_cast<uint32_t>(current >> 32) != jobGeneration) return -1;
+    int index = static_cast<int>(current & 0xffffffffu);
+    if (index >= numTasks.load(std::memory_order_relaxed)) return -1;
+    if (ticket.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel,
+                                     std::memory_order_acquire))
+      return index;
+  }
+}
+
+void RenderPool::work(uint32_t jobGeneration) {
+  for (int index; (index = claim(jobGeneration)) >= 0;) {
+    task.load(std::memory_order_relaxed)(context.load(std::memory_order_relaxed), index);
+    completed.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void RenderPool::run(Task taskToRun, void* taskContext, int count) {
+  if (count <= 0) return;
+  if (workers.empty() || count == 1 || busy.exchange(true, std::memory_order_acquire)) {
+    for (int i = 0; i < count; ++i) taskToRun(taskContext, i);
+    return;
+  }
+
+  task.store(taskToRun, std::memory_order_relaxed);
+  context.store(taskContext, std::memory_order_relaxed);
+  numTasks.store(count, std::memory_order_relaxed);
+  completed.store(0, std::memory_order_relaxed);
+  ++generation;
+  // publishes everything above to whoever claims a task of this generation
+  ticket.store(static_cast<uint64_t>(generation) << 32, std::memory_order_release);
+  published.store(generation, std::memory_order_release);
+
+  // the caller takes a share itself, so wake one worker fewer than there are tasks
+  int helpers = juce::jmin(count - 1, getNumWorkers());
+  for (int i = 0; i < helpers; ++i) published.notify_one();
+
+  work(generation);
+
+  // whatever is left was claimed by a worker and is being rendered right now
+  for (int spins = 0; completed.load(std::memory_order_acquire) < count; ++spins)
+    if (spins > 4096) std::this_thread::yield();
+
+  busy.store(false, std::memory_order_release);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// A process-wide pool of real-time worker threads that the audio thread can
+// split one render into, held through juce::SharedResourcePointer<RenderPool>
+// so that every instance shares the same few threads.
+//
+// run(task, context, count) calls task(context, i) once for each i in
+// [0, count), spread over the workers and the calling thread, and returns
+// when all of them are done. Tasks are claimed and completed through atomic
+// counters; nothing on the audio thread locks or allocates, and the caller
+// always claims tasks too, so a worker that is slow to wake costs latency,
+// never a deadlock. If another instance is using the pool (it is saturated),
+// or there are no workers, the tasks simply run inline on the caller.
+//
+// Idle workers sleep in published.wait() (C++20 atomic waiting), so waking
+// them is a futex wake on Linux, __ulock_wake on macOS and WakeByAddress on
+// Windows: a system call, but no mutex or condition variable.
+//
+// Tasks must be independent: each writes only its own preallocated buffer.
+class RenderPool {
+ public:
+  using Task = void (*)(void* context, int index);
+
+  RenderPool();
+  ~RenderPool();
+
+  // one per core, less the caller's, up to maxWorkers
+  int getNumWorkers() const { return static_cast<int>(workers.size()); }
+  static constexpr int maxWorkers = 15;
+
+  // audio thread
+  void run(Task task, void* context, int count);
+
+ private:
+  class Worker : public juce::Thread {
+   public:
+    explicit Worker(RenderPool& owner) : juce::Thread("Render Worker"), pool(owner) {}
+    void run() override;
+
+   private:
+    RenderPool& pool;
+  };
+
+  int claim(uint32_t generation);
+  void work(uint32_t generation);
+
+  // the job being run: its generation in the top 32 bits of `ticket` and the
+  // next unclaimed task in the bottom 32, so a worker still holding an old
+  // generation can never claim a task of the next job
+  std::atomic<uint64_t> ticket{0};
+  std::atomic<uint32_t> published{0};
+  std::atomic<int> completed{0};
+  std::atomic<int> numTasks{0};
+  std::atomic<Task> task{nullptr};
+  std::atomic<void*> context{nullptr};
+  std::atomic<bool> busy{false};
+  uint32_t generation = 0;  // guarded by `busy`
+
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderPool)
+};
@@ -0,0 +1,86 @@
+#include "SampleStream.h"
+
+std::unique_ptr<SampleStream> SampleStream::open(
+    const juce::File& file, juce::TimeSliceThread& thread) {
+  std::unique_ptr<juce::AudioFormatReader> reader;
+
+  // WAV can be memory-mapped: pages are faulted in by the read-ahead thread
+  // as it goes, so nothing is loaded up front
+  if (file.hasFileExtension("wav")) {
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(
+        wav.createMemoryMappedReader(file));
+    if (mapped != nullptr && mapped->mapEntireFile()) reader = std::move(mapped);
+  }
+
+  if (reader == nullptr) {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    reader.reset(formatManager.createReaderFor(file));
+  }
+
+  if (reader == nullptr || reader->lengthInSamples <= 0) return nullptr;
+
+  return std::make_unique<SampleStream>(std::move(reader), thread);
+}
+
+SampleStream::SampleStream(std::unique_ptr<juce::AudioFormatReader> r,
+                           juce::TimeSliceThread& t, int ringSize)
+    : reader(std::move(r)),
+      thread(t),
+      fifo(ringSize),
+      ring(static_cast<size_t>(ringSize), 0.0f),
+      chunk(juce::jmin(2, static_cast<int>(reader->numChannels)), chunkSize),
+      sampleRate(reader->sampleRate),
+      length(reader->lengthInSamples) {
+  thread.addTimeSliceClient(this);
+}
+
+SampleStream::~SampleStream() { thread.removeTimeSliceClient(this); }
+
+int SampleStream::read(float* destination, int numSamples) {
+  int start1, size1, start2, size2;
+  fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+  if (size1 > 0)
+    std::copy_n(ring.data() + start1, size1, destination);
+  if (size2 > 0)
+    std::copy_n(ring.data() + start2, size2, destination + size1);
+
+  fifo.finishedRead(size1 + size2);
+
+  int delivered = size1 + size2;
+  if (delivered < numSamples)
+    std::fill(destination + delivered, destination + numSamples, 0.0f);
+
+  return delivered;
+}
+
+int SampleStream::useTimeSlice() {
+  // ring is full; check back later
+  if (fifo.getFreeSpace() < chunkSize) return 10;
+
+  int count = static_cast<int>(
+      juce::jmin(static_cast<juce::int64>(chunkSize), length - readPosition));
+
+  reader->read(&chunk, 0, count, readPosition, true, true);
+
+  // mix down to mono
+  if (chunk.getNumChannels() > 1) {
+    chunk.addFrom(0, 0, chunk, 1, 0, count);
+    chunk.applyGain(0, 0, count, 0.5f);
+  }
+
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(count, start1, size1, start2, size2);
+  const float* source = chunk.getReadPointer(0);
+  if (size1 > 0) std::copy_n(source, size1, ring.data() + start1);
+  if (size2 > 0) std::copy_n(source + size1, size2, ring.data() + start2);
+  fifo.finishedWrite(size1 + size2);
+
+  // loop back to the start of the file
+  readPosition += count;
+  if (readPosition >= length) readPosition = 0;
+
+  return 0;
+}
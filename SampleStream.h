@@ -0,0 +1,47 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <memory>
+#include <vector>
+
+// Streams an audio file of any length from disk into a bounded, lock-free
+// ring of mono samples. A background TimeSliceThread reads ahead (WAV files
+// are memory-mapped rather than read through a stream); the audio thread only
+// ever copies out of the ring. Memory use is fixed by the ring size, and
+// opening a file only parses its header, so loading is instant.
+class SampleStream : private juce::TimeSliceClient {
+ public:
+  // returns nullptr if the file can't be read
+  static std::unique_ptr<SampleStream> open(const juce::File& file,
+                                            juce::TimeSliceThread& thread);
+
+  SampleStream(std::unique_ptr<juce::AudioFormatReader> reader,
+               juce::TimeSliceThread& thread, int ringSize = 1 << 17);
+  ~SampleStream() override;
+
+  SampleStream(SampleStream const&) = delete;
+  void operator=(SampleStream const&) = delete;
+
+  // audio thread: copy up to numSamples samples into destination, looping at
+  // the end of the file. On underrun the remainder is zero-filled. Returns the
+  // number of samples that came from the file.
+  int read(float* destination, int numSamples);
+
+  double getSampleRate() const { return sampleRate; }
+  juce::int64 getLengthInSamples() const { return length; }
+
+ private:
+  int useTimeSlice() override;
+
+  static constexpr int chunkSize = 4096;
+
+  std::unique_ptr<juce::AudioFormatReader> reader;
+  juce::TimeSliceThread& thread;
+  juce::AbstractFifo fifo;
+  std::vector<float> ring;
+  juce::AudioBuffer<float> chunk;  // background thread only
+  juce::int64 readPosition = 0;    // background thread only
+  double sampleRate = 0;
+  juce::int64 length = 0;
+};
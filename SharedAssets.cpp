@@ -0,0 +1,33 @@
+#include "SharedAssets.h"
+
+#include <cmath>
+
+SharedAssets::SharedAssets() {
+  for (int i = 0; i <= wavetableSize; ++i)
+    sine[static_cast<size_t>(i)] = static_cast<float>(
+        std::sin(juce::MathConstants<double>::twoPi * i / wavetableSize));
+}
+
+std::shared_ptr<const SharedAssets::ImpulseResponse> SharedAssets::getImpulseResponse(
+    const juce::File& file) {
+  const juce::ScopedLock sl(lock);
+
+  auto key = file.getFullPathName();
+  if (auto found = impulseResponses.find(key); found != impulseResponses.end())
+    return found->second;
+
+  juce::AudioFormatManager formats;
+  formats.registerBasicFormats();
+  std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+  if (reader == nullptr || reader->lengthInSamples <= 0) return nullptr;
+
+  auto ir = std::make_shared<ImpulseResponse>();
+  ir->sampleRate = reader->sampleRate;
+  ir->audio.setSize(juce::jmin(2, static_cast<int>(reader->numChannels)),
+                    static_cast<int>(reader->lengthInSamples));
+  if (!reader->read(&ir->audio, 0, ir->audio.getNumSamples(), 0, true, true))
+    return nullptr;
+
+  impulseResponses[key] = ir;
+  return ir;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <map>
+#include <memory>
+
+// Read-only data that every plugin instance in the process can share, held
+// through juce::SharedResourcePointer<SharedAssets>: the last instance to go
+// takes it with it. Only per-instance state (convolution history, phases and
+// so on) is duplicated.
+//
+//  - decoded impulse responses, read from disk once per file
+//  - one background thread that builds the convolution engines of every
+//    instance, instead of one thread each
+//  - wavetables
+//
+// The backdrop pictures are shared the same way, by BackdropImages.
+class SharedAssets {
+ public:
+  struct ImpulseResponse {
+    juce::AudioBuffer<float> audio;
+    double sampleRate = 0;
+  };
+
+  // a single cycle, with a guard point so that table[i + 1] is always valid
+  // for linear interpolation
+  static constexpr int wavetableSize = 4096;
+  using Wavetable = std::array<float, wavetableSize + 1>;
+
+  SharedAssets();
+
+  // message thread: the decoded file, or null if it can't be read. Decoded
+  // on the first request; later ones (from any instance) share it.
+  std::shared_ptr<const ImpulseResponse> getImpulseResponse(const juce::File& file);
+
+  juce::dsp::ConvolutionMessageQueue& getConvolutionQueue() { return convolutionQueue; }
+
+  const Wavetable& getSine() const { return sine; }
+
+ private:
+  juce::CriticalSection lock;
+  std::map<juce::String, std::shared_ptr<const ImpulseResponse>> impulseResponses;
+  juce::dsp::ConvolutionMessageQueue convolutionQueue;
+  Wavetable sine;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedAssets)
+};
@@ -0,0 +1,112 @@
+#include "StringBank.h"
+
+#include <algorithm>
+#include <cmath>
+
+void StringBank::prepare(float sampleRate, float lowestFrequency) {
+  samplerate = sampleRate;
+  length = 2 + static_cast<size_t>(sampleRate / lowestFrequency);
+  lines.assign(maxStrings * 2 * length, 0.0f);
+  scratch.assign(length, 0.0f);
+  for (auto& s : strings) s = String{};
+  sounding = 0;
+}
+
+void StringBank::silence() {
+  for (auto& s : strings) s.active = false;
+  sounding = 0;
+}
+
+void StringBank::pluck(float hertz, float velocity) {
+  if (length == 0 || hertz <= 0) return;
+
+  // prefer a silent string, otherwise steal the one plucked longest ago
+  int index = 0;
+  for (int i = 0; i < maxStrings; ++i) {
+    if (!strings[i].active) {
+      index = i;
+      break;
+    }
+    if (strings[i].age > strings[index].age) index = i;
+  }
+
+  // the span logic needs a period of at least 2 samples
+  float period = std::clamp(samplerate / hertz, 2.0f,
+                            static_cast<float>(length) - 2);
+
+  String& s = strings[index];
+  s.delay = static_cast<int>(period);
+  s.fraction = period - s.delay;
+  // per period, lose the share of 60 dB that falls within it
+  s.loopGain = std::pow(0.001f, period / (decaySeconds * samplerate));
+  s.beta = brightness;
+  s.history = 0;
+  s.write = 0;
+  s.age = 0;
+  s.lifetime = static_cast<int>(decaySeconds * samplerate);
+  if (!s.active) ++sounding;
+  s.active = true;
+
+  // excite the samples the first span will read: the last delay + 1 slots
+  // before the write head, and their mirrors
+  float* line = lineFor(index);
+  float* excitation = line + length - s.delay - 1;
+  int count = s.delay + 1;
+  random.fill(excitation, count);
+  for (int i = 0; i < count; ++i) {
+    excitation[i] *= velocity;
+    excitation[i + length] = excitation[i];
+  }
+}
+
+void StringBank::process(float* output, int numSamples) {
+  std::fill(output, output + numSamples, 0.0f);
+  for (int i = 0; i < maxStrings; ++i) {
+    if (strings[i].active) render(i, output, numSamples);
+  }
+}
+
+void StringBank::render(int index, float* output, int numSamples) {
+  String& s = strings[index];
+  float* line = lineFor(index);
+  float* in = scratch.data();
+  const int size = static_cast<int>(length);
+  const float a = 1 - s.fraction;
+  const float b = s.fraction;
+  const float g0 = s.loopGain * s.beta;
+  const float g1 = s.loopGain * (1 - s.beta);
+
+  int done = 0;
+  while (done < numSamples) {
+    // a span never reads what it writes and never crosses the mirror
+    int span = std::min({numSamples - done, s.delay - 1, size - s.write});
+
+    // x[n - delay - 1] for the first sample of the span
+    const float* past = line + s.write + size - s.delay - 1;
+    for (int i = 0; i < span; ++i) {
+      in[i] = a * past[i + 1] + b * past[i];
+    }
+
+    float* head = line + s.write;
+    float* out = output + done;
+    head[0] = g0 * in[0] + g1 * s.history;
+    for (int i = 1; i < span; ++i) {
+      head[i] = g0 * in[i] + g1 * in[i - 1];
+    }
+    for (int i = 0; i < span; ++i) {
+      head[i + size] = head[i];
+      out[i] += head[i];
+    }
+
+    s.history = in[span - 1];
+    s.write += span;
+    if (s.write == size) s.write = 0;
+    done += span;
+  }
+
+  s.age += numSamples;
+  if (s.age >= s.lifetime) {
+    s.active = false;
+    --sounding;
+  }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "Library.h"
+
+// A bank of Karplus-Strong strings for the plucked layer. Every string's delay
+// line is sized for the lowest playable pitch and allocated once in prepare(),
+// so plucking (even all strings at once) never allocates.
+//
+// Each delay line is stored twice, back to back, so that any run of up to
+// `delay - 1` samples can be read and written as one contiguous span. The
+// string recursion only looks `delay` samples into the past, so a whole span
+// is independent and its inner loops vectorize.
+class StringBank {
+ public:
+  static constexpr int maxStrings = 32;
+
+  void prepare(float sampleRate, float lowestFrequency = 27.5f);
+  void seed(uint64_t s) { random.seed(s); }
+
+  // decay time to -60 dB, in seconds
+  void setDecay(float seconds) { decaySeconds = seconds; }
+  float getDecay() const { return decaySeconds; }
+
+  // beta on (0, 1]; lower is darker (more averaging in the loop filter)
+  void setBrightness(float beta) { brightness = beta; }
+
+  // audio thread; reuses a free string or steals the oldest one
+  void pluck(float hertz, float velocity);
+
+  // overwrites output with the sum of all sounding strings
+  void process(float* output, int numSamples);
+
+  // true once every string has rung out; process() would only write zeros
+  bool isSilent() const { return sounding == 0; }
+
+  // stop every string at once
+  void silence();
+
+ private:
+  struct String {
+    int delay = 0;      // integer part of the period, in samples
+    float fraction = 0; // fractional part of the period
+    float loopGain = 1;
+    float beta = 0.5f;
+    float history = 0;  // previous filter input
+    int write = 0;
+    int age = 0;        // samples since the pluck
+    int lifetime = 0;   // samples until the string is considered silent
+    bool active = false;
+  };
+
+  float* lineFor(int index) {
+    return lines.data() + static_cast<size_t>(index) * 2 * length;
+  }
+  void render(int index, float* output, int numSamples);
+
+  std::array<String, maxStrings> strings;
+  std::vector<float> lines;    // maxStrings mirrored delay lines
+  std::vector<float> scratch;  // filter input for one span
+  size_t length = 0;           // samples per delay line (before mirroring)
+  float samplerate = 0;
+  float decaySeconds = 4;
+  float brightness = 0.5f;
+  int sounding = 0;  // strings with active set
+  ky::Random random;
+};
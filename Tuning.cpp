@@ -0,0 +1,26 @@
+#include "Tuning.h"
+
+const char* Tuning::getModeName(int mode) {
+  static const char* const names[numModes] = {
+      "Major Pentatonic", "Minor Pentatonic", "Ionian", "Dorian", "Phrygian",
+      "Lydian", "Mixolydian", "Aeolian", "Locrian"};
+  return names[juce::jlimit(0, numModes - 1, mode)];
+}
+
+const char* Tuning::getTemperamentName(int temperament) {
+  static const char* const names[numTemperaments] = {"Just", "Equal", "Pythagorean"};
+  return names[juce::jlimit(0, numTemperaments - 1, temperament)];
+}
+
+juce::StringArray Tuning::getModeNames() {
+  juce::StringArray result;
+  for (int m = 0; m < numModes; ++m) result.add(getModeName(m));
+  result.add("Custom (Scala)");
+  return result;
+}
+
+juce::StringArray Tuning::getTemperamentNames() {
+  juce::StringArray result;
+  for (int t = 0; t < numTemperaments; ++t) result.add(getTemperamentName(t));
+  return result;
+}
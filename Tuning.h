@@ -0,0 +1,214 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Scales, temperaments and root frequencies, all computed at compile time, so
+// building a chord on the audio thread is a couple of table lookups and a
+// multiply per partial (no pow()).
+//
+// A scale is the ratios of its degrees to the root over one period, starting
+// at 1/1 and ending with the period itself (2/1 for the built-in ones): the
+// pad plays every ratio as one partial. The built-in modes are chosen from
+// the 12 chromatic steps, tuned by one of the temperaments. A custom scale is
+// read from Scala (.scl) text, at compile time or at run time.
+class Tuning {
+ public:
+  static constexpr int maxDegrees = 32;  // partials per chord, period included
+
+  struct Scale {
+    int size = 0;  // 0: not a valid scale
+    std::array<float, maxDegrees> ratios{};
+  };
+
+  enum Mode {
+    majorPentatonic,
+    minorPentatonic,
+    ionian,
+    dorian,
+    phrygian,
+    lydian,
+    mixolydian,
+    aeolian,
+    locrian,
+    numModes
+  };
+  enum Temperament { just, equal, pythagorean, numTemperaments };
+
+  static const char* getModeName(int mode);
+  static const char* getTemperamentName(int temperament);
+  static juce::StringArray getModeNames();  // then "Custom (Scala)"
+  static juce::StringArray getTemperamentNames();
+
+  static constexpr const Scale& getScale(int mode, int temperament) {
+    return scales[static_cast<size_t>(juce::jlimit(0, numModes - 1, mode))]
+                 [static_cast<size_t>(juce::jlimit(0, numTemperaments - 1, temperament))];
+  }
+
+  // 12-TET, A4 = 440 Hz
+  static constexpr float getRootFrequency(int midiNote) {
+    return rootFrequencies[static_cast<size_t>(juce::jlimit(0, 127, midiNote))];
+  }
+
+  // Scala .scl text: '!' starts a comment line; then a description line, the
+  // number of pitches, and one pitch per line, in cents if it has a '.'
+  // ("701.955") or else as a ratio ("3/2", "2"). The size is 0 if the text is
+  // malformed; pitches past maxDegrees - 1 are dropped.
+  static constexpr Scale fromScala(std::string_view text);
+
+  // 2^x, good to double precision over the range used here
+  static constexpr double exp2(double x) {
+    int whole = static_cast<int>(x);
+    if (static_cast<double>(whole) > x) --whole;
+    double f = (x - whole) * 0.69314718055994530942;  // ln 2
+    double term = 1, sum = 1;
+    for (int k = 1; k < 24; ++k) sum += (term *= f / k);
+    for (; whole > 0; --whole) sum *= 2;
+    for (; whole < 0; ++whole) sum /= 2;
+    return sum;
+  }
+
+ private:
+  // the twelve chromatic steps above the root, in each temperament
+  using Steps = std::array<double, 13>;
+  static constexpr std::array<Steps, numTemperaments> steps() {
+    std::array<Steps, numTemperaments> t{};
+    t[just] = {1.0, 16.0 / 15, 9.0 / 8, 6.0 / 5, 5.0 / 4, 4.0 / 3, 45.0 / 32,
+               3.0 / 2, 8.0 / 5, 5.0 / 3, 9.0 / 5, 15.0 / 8, 2.0};
+    t[pythagorean] = {1.0, 256.0 / 243, 9.0 / 8, 32.0 / 27, 81.0 / 64, 4.0 / 3, 729.0 / 512,
+                      3.0 / 2, 128.0 / 81, 27.0 / 16, 16.0 / 9, 243.0 / 128, 2.0};
+    for (int s = 0; s <= 12; ++s) t[equal][static_cast<size_t>(s)] = exp2(s / 12.0);
+    return t;
+  }
+
+  // each mode's degrees, in chromatic steps; -1 ends a short one
+  static constexpr std::array<std::array<int, 7>, numModes> modeSteps{{
+      {0, 2, 4, 7, 9, -1, -1},
+      {0, 3, 5, 7, 10, -1, -1},
+      {0, 2, 4, 5, 7, 9, 11},
+      {0, 2, 3, 5, 7, 9, 10},
+      {0, 1, 3, 5, 7, 8, 10},
+      {0, 2, 4, 6, 7, 9, 11},
+      {0, 2, 4, 5, 7, 9, 10},
+      {0, 2, 3, 5, 7, 8, 10},
+      {0, 1, 3, 5, 6, 8, 10},
+  }};
+
+  using ScaleTable = std::array<std::array<Scale, numTemperaments>, numModes>;
+  static constexpr ScaleTable buildScales() {
+    ScaleTable table{};
+    constexpr auto chromatic = steps();
+    for (size_t m = 0; m < numModes; ++m)
+      for (size_t t = 0; t < numTemperaments; ++t) {
+        Scale& scale = table[m][t];
+        for (int step : modeSteps[m])
+          if (step >= 0)
+            scale.ratios[static_cast<size_t>(scale.size++)] =
+                static_cast<float>(chromatic[t][static_cast<size_t>(step)]);
+        scale.ratios[static_cast<size_t>(scale.size++)] = 2.0f;
+      }
+    return table;
+  }
+
+  static constexpr std::array<float, 128> buildRootFrequencies() {
+    std::array<float, 128> table{};
+    for (int n = 0; n < 128; ++n)
+      table[static_cast<size_t>(n)] = static_cast<float>(440.0 * exp2((n - 69) / 12.0));
+    return table;
+  }
+
+  static const ScaleTable scales;
+  static const std::array<float, 128> rootFrequencies;
+};
+
+inline constexpr Tuning::ScaleTable Tuning::scales = Tuning::buildScales();
+inline constexpr std::array<float, 128> Tuning::rootFrequencies = Tuning::buildRootFrequencies();
+
+constexpr Tuning::Scale Tuning::fromScala(std::string_view text) {
+  Scale scale;
+  scale.ratios[0] = 1.0f;
+  int expected = -1;  // pitch count, once read
+  bool described = false;
+  int read = 0;
+
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text = end == std::string_view::npos ? std::string_view{} : text.substr(end + 1);
+
+    if (!line.empty() && line.front() == '!') continue;
+    if (!described) {  // the description, which may be empty
+      described = true;
+      continue;
+    }
+    while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+    if (line.empty() || line.front() == '\r') continue;
+
+    // digits, then either .digits (cents) or /digits (a ratio); the rest of
+    // the line is a comment
+    size_t i = 0;
+    auto digits = [&line, &i](auto& number) {
+      size_t first = i;
+      for (; i < line.size() && line[i] >= '0' && line[i] <= '9'; ++i)
+        number = number * 10 + static_cast<unsigned>(line[i] - '0');
+      return i - first;
+    };
+    bool negative = i < line.size() && line[i] == '-';
+    if (negative) ++i;
+    double value = 0;
+    uint64_t denominator = 1;  // an integer, so a zero is exact
+    bool cents = false;
+    bool any = digits(value) > 0;
+    if (i < line.size() && line[i] == '.') {
+      ++i;
+      cents = true;
+      double fraction = 0;
+      size_t places = digits(fraction);
+      for (; places > 0; --places) fraction /= 10;
+      value += fraction;
+      any = true;
+    } else if (i < line.size() && line[i] == '/') {
+      ++i;
+      denominator = 0;
+      if (digits(denominator) == 0 || denominator == 0) return {};
+    }
+    if (!any || (negative && !cents)) return {};
+    if (negative) value = -value;
+
+    if (expected < 0) {
+      expected = static_cast<int>(value);
+      if (expected <= 0) return {};
+      continue;
+    }
+
+    double ratio = cents ? exp2(value / 1200.0) : value / static_cast<double>(denominator);
+    if (ratio <= 0) return {};
+    if (++read < maxDegrees) scale.ratios[static_cast<size_t>(read)] = static_cast<float>(ratio);
+    if (read == expected) break;
+  }
+
+  if (expected <= 0 || read < expected) return {};
+  scale.size = juce::jmin(read, maxDegrees - 1) + 1;
+  return scale;
+}
+
+// fromScala at compile time: ratios, cents, comments and malformed text
+static_assert([] {
+  constexpr auto scale = Tuning::fromScala(
+      "! just.scl\n!\nJust pentatonic\n 5\n!\n9/8\n5/4 major third\n3/2\n5/3\n2\n");
+  double fifth = scale.ratios[3] - 1.5, octave = scale.ratios[5] - 2.0;
+  return scale.size == 6 && fifth > -1e-7 && fifth < 1e-7 && octave > -1e-7 && octave < 1e-7;
+}());
+static_assert([] {
+  constexpr auto scale = Tuning::fromScala("Fifths\n2\n701.955\n3/2\n");
+  double difference = scale.ratios[1] - scale.ratios[2];
+  return scale.size == 3 && difference > -1e-6 && difference < 1e-6;
+}());
+static_assert(Tuning::fromScala("").size == 0);
+static_assert(Tuning::fromScala("Too few\n3\n3/2\n2/1\n").size == 0);
+static_assert(Tuning::fromScala("Zero denominator\n1\n3/0\n").size == 0);
+static_assert(Tuning::fromScala("Negative ratio\n1\n-3/2\n").size == 0);
+static_assert(Tuning::fromScala("Not a number\nfour\n").size == 0);
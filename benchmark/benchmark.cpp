@@ -0,0 +1,427 @@
+// Micro-benchmarks for the ky primitives, AdditiveSynth, the convolution
+// reverb and the whole processor. Every case runs at each sample rate and block size and reports the
+// best of several runs as nanoseconds per sample (per channel frame).
+//
+//   Benchmark [--json] [--seconds S] [--filter substring] [--output file]
+//
+// Output is CSV by default, JSON with --json.
+
+#include <JuceHeader.h>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../AdditiveSynth.h"
+#include "../FilterBank.h"
+#include "../Library.h"
+#include "../PluginProcessor.h"
+#include "../RenderPool.h"
+#include "../StringBank.h"
+
+namespace {
+
+struct Result {
+  std::string name;
+  std::string variant;
+  double sampleRate;
+  int blockSize;
+  double nsPerSample;
+};
+
+struct Options {
+  bool json = false;
+  double seconds = 1.0;
+  std::string filter;
+  std::string output;
+};
+
+const double sampleRates[] = {44100, 48000, 96000};
+const int blockSizes[] = {32, 64, 128, 256, 512, 1024, 4096};
+constexpr int repetitions = 5;
+
+// A case is set up once per (sample rate, block size) and returns a function
+// that processes one block of `blockSize` samples.
+using Block = std::function<void()>;
+using Setup = std::function<Block(double sampleRate, int blockSize)>;
+
+struct Case {
+  std::string name;
+  std::string variant;
+  Setup setup;
+};
+
+double measure(const Block& block, double sampleRate, int blockSize,
+               double seconds) {
+  const int blocks = juce::jmax(
+      1, static_cast<int>(seconds * sampleRate / blockSize));
+
+  // warm up caches and branch predictors
+  for (int i = 0; i < juce::jmin(blocks, 16); ++i) block();
+
+  double best = std::numeric_limits<double>::max();
+  for (int r = 0; r < repetitions; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < blocks; ++i) block();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    best = std::min(best, ns / (static_cast<double>(blocks) * blockSize));
+  }
+  return best;
+}
+
+// input shared by the filter cases: white noise, so nothing decays to denormals
+std::vector<float> noiseBlock(int blockSize) {
+  std::vector<float> v(static_cast<size_t>(blockSize));
+  ky::Random random(1);
+  random.fill(v.data(), blockSize);
+  return v;
+}
+
+template <typename Filter>
+Setup perSampleFilter(std::function<void(Filter&)> configure) {
+  return [configure](double, int blockSize) -> Block {
+    auto filter = std::make_shared<Filter>();
+    configure(*filter);
+    auto input = std::make_shared<std::vector<float>>(noiseBlock(blockSize));
+    auto output = std::make_shared<std::vector<float>>(input->size());
+    return [=] {
+      for (size_t i = 0; i < input->size(); ++i)
+        (*output)[i] = (*filter)((*input)[i]);
+    };
+  };
+}
+
+// The fixed-size filters take their rate as a template argument: make() gets
+// it as a std::integral_constant, one of the rates in sampleRates
+template <typename Make>
+Block atFixedRate(double sampleRate, Make make) {
+  switch (static_cast<int>(sampleRate)) {
+    case 44100:
+      return make(std::integral_constant<unsigned, 44100>{});
+    case 96000:
+      return make(std::integral_constant<unsigned, 96000>{});
+    default:
+      return make(std::integral_constant<unsigned, 48000>{});
+  }
+}
+
+template <typename Filter>
+Block fixedFilter(int blockSize) {
+  auto filter = std::make_shared<Filter>();
+  auto input = std::make_shared<std::vector<float>>(noiseBlock(blockSize));
+  auto output = std::make_shared<std::vector<float>>(input->size());
+  return [=] { filter->process(input->data(), output->data(), blockSize); };
+}
+
+std::vector<Case> makeCases() {
+  std::vector<Case> cases;
+
+  cases.push_back({"DelayLine", "1s", [](double sampleRate, int blockSize) -> Block {
+    auto line = std::make_shared<ky::DelayLine>();
+    line->resize(static_cast<size_t>(sampleRate));
+    auto input = std::make_shared<std::vector<float>>(noiseBlock(blockSize));
+    auto output = std::make_shared<std::vector<float>>(input->size());
+    float delay = static_cast<float>(sampleRate) * 0.3713f;
+    return [=] {
+      for (size_t i = 0; i < input->size(); ++i) {
+        (*output)[i] = line->read(delay);
+        line->write((*input)[i]);
+      }
+    };
+  }});
+
+  cases.push_back({"CombFeedback", "runtime",
+                   perSampleFilter<ky::CombFeedback>(
+                       [](auto& f) { f.configure(0.06712f, 0.773f); })});
+  cases.push_back({"AllPass", "runtime",
+                   perSampleFilter<ky::AllPass>(
+                       [](auto& f) { f.configure(0.01388f, 0.7f); })});
+  cases.push_back({"SchroederReverb", "runtime",
+                   perSampleFilter<ky::SchroederReverb>(
+                       [](auto& f) { f.configure(); })});
+
+  cases.push_back({"CombFeedback", "fixed", [](double sampleRate, int blockSize) -> Block {
+    return atFixedRate(sampleRate, [blockSize](auto rate) {
+      constexpr unsigned r = decltype(rate)::value;
+      return fixedFilter<ky::FixedCombFeedback<ky::samplesAt(0.06712, r), 773>>(blockSize);
+    });
+  }});
+  cases.push_back({"AllPass", "fixed", [](double sampleRate, int blockSize) -> Block {
+    return atFixedRate(sampleRate, [blockSize](auto rate) {
+      constexpr unsigned r = decltype(rate)::value;
+      return fixedFilter<ky::FixedAllPass<ky::samplesAt(0.01388, r), 700>>(blockSize);
+    });
+  }});
+  cases.push_back({"SchroederReverb", "fixed", [](double sampleRate, int blockSize) -> Block {
+    return atFixedRate(sampleRate, [blockSize](auto rate) {
+      return fixedFilter<ky::FixedSchroederReverb<decltype(rate)::value>>(blockSize);
+    });
+  }});
+
+  cases.push_back({"KarplusStrong", "110Hz", [](double, int blockSize) -> Block {
+    auto string = std::make_shared<ky::KarplusStrong>();
+    string->pluck(110, 1, 0.5f);
+    auto output = std::make_shared<std::vector<float>>(static_cast<size_t>(blockSize));
+    return [=] {
+      for (auto& sample : *output) sample = (*string)();
+    };
+  }});
+
+  // a one-second clip recorded at 44.1 kHz, played a fifth up
+  for (int taps : {4, 8, 16, 32}) {
+    cases.push_back({"ClipPlayer", std::to_string(taps) + " taps",
+                     [taps](double sampleRate, int blockSize) -> Block {
+      auto clip = std::make_shared<ky::ClipPlayer>();
+      for (float sample : noiseBlock(44100)) clip->addSample(sample);
+      clip->setTaps(taps);
+      clip->prepare(blockSize);
+      auto output = std::make_shared<std::vector<float>>(static_cast<size_t>(blockSize));
+      double increment = 44100 / sampleRate * 1.5;
+      return [=] { clip->render(output->data(), blockSize, increment); };
+    }});
+  }
+
+  cases.push_back({"StringBank", "32 strings", [](double sampleRate, int blockSize) -> Block {
+    auto bank = std::make_shared<StringBank>();
+    bank->prepare(static_cast<float>(sampleRate));
+    bank->setDecay(1000);  // keep every string sounding for the whole run
+    for (int i = 0; i < StringBank::maxStrings; ++i)
+      bank->pluck(ky::mtof(40.0f + i), 1);
+    auto output = std::make_shared<std::vector<float>>(static_cast<size_t>(blockSize));
+    return [=] { bank->process(output->data(), blockSize); };
+  }});
+
+  // N lowpass filters, each on its own channel, with the cutoff gliding
+  for (int filters : {1, 4, 16, 64}) {
+    auto name = std::to_string(filters) + " filters";
+    cases.push_back({"FilterBank", name, [filters](double sampleRate, int blockSize) -> Block {
+      auto bank = std::make_shared<FilterBank>();
+      bank->prepare(sampleRate, filters);
+      auto noise = noiseBlock(blockSize);
+      auto channels = std::make_shared<std::vector<std::vector<float>>>(
+          static_cast<size_t>(filters), noise);
+      auto pointers = std::make_shared<std::vector<float*>>();
+      for (auto& c : *channels) pointers->push_back(c.data());
+      auto flip = std::make_shared<bool>(false);
+      return [=] {
+        *flip = !*flip;
+        for (int f = 0; f < filters; ++f) bank->setCutoff(f, *flip ? 500.0f : 5000.0f, blockSize);
+        bank->process(pointers->data(), blockSize);
+      };
+    }});
+    cases.push_back({"StateVariableTPTFilter", name,
+                     [filters](double sampleRate, int blockSize) -> Block {
+      auto filter = std::make_shared<juce::dsp::StateVariableTPTFilter<float>>();
+      filter->prepare({sampleRate, static_cast<juce::uint32>(blockSize),
+                       static_cast<juce::uint32>(filters)});
+      auto channels = std::make_shared<juce::AudioBuffer<float>>(filters, blockSize);
+      auto noise = noiseBlock(blockSize);
+      for (int f = 0; f < filters; ++f) channels->copyFrom(f, 0, noise.data(), blockSize);
+      auto flip = std::make_shared<bool>(false);
+      return [=] {
+        // the old way: one tan() per block, then a step
+        *flip = !*flip;
+        filter->setCutoffFrequency(*flip ? 500.0f : 5000.0f);
+        juce::dsp::AudioBlock<float> block(*channels);
+        filter->process(juce::dsp::ProcessContextReplacing<float>(block));
+      };
+    }});
+  }
+
+  // one thread, then as many as the render pool has: how far big chords scale
+  const int allThreads = juce::SharedResourcePointer<RenderPool>()->getNumWorkers() + 1;
+  for (int threads : {1, allThreads}) {
+    for (int partials : {6, 12, 24, 48, 96, 384}) {
+      if (threads > 1 && partials < 48) continue;
+      cases.push_back({"AdditiveSynth",
+                       std::to_string(partials) + " partials, " + std::to_string(threads) +
+                           (threads > 1 ? " threads" : " thread"),
+                       [partials, threads](double sampleRate, int blockSize) -> Block {
+        auto synth = std::make_shared<AdditiveSynth>();
+        synth->prepare(sampleRate, blockSize);
+        synth->setThreadLimit(threads);
+        std::vector<float> ratios;
+        for (int i = 1; i <= partials; ++i) ratios.push_back(static_cast<float>(i));
+        synth->setChord(55, ratios.data(), partials);
+        auto output = std::make_shared<juce::AudioBuffer<float>>(2, blockSize);
+        return [=] {
+          synth->render(output->getWritePointer(0), output->getWritePointer(1), blockSize);
+        };
+      }});
+    }
+  }
+
+  // unison: 2 and 4 voices share 4 lanes, 8 take 8 (one AVX2 register)
+  for (int voices : {1, 2, 4, 8}) {
+    cases.push_back({"AdditiveSynth unison", std::to_string(voices) + " voices, 24 partials",
+                     [voices](double sampleRate, int blockSize) -> Block {
+      auto synth = std::make_shared<AdditiveSynth>();
+      synth->prepare(sampleRate, blockSize);
+      synth->setThreadLimit(1);
+      synth->setUnison(voices, 15.0f, 1.0f);
+      std::vector<float> ratios;
+      for (int i = 1; i <= 24; ++i) ratios.push_back(static_cast<float>(i));
+      synth->setChord(55, ratios.data(), 24);
+      auto output = std::make_shared<juce::AudioBuffer<float>>(2, blockSize);
+      return [=] {
+        synth->render(output->getWritePointer(0), output->getWritePointer(1), blockSize);
+      };
+    }});
+  }
+
+  // the whole processBlock, as a host calls it. The pad renders a chunk at a
+  // time, so a big chord still spreads over the pool when the host's blocks
+  // are small; the big one is a 31-note Scala scale (32 partials) in unison.
+  auto scala = std::make_shared<juce::TemporaryFile>(".scl");
+  {
+    juce::String text = "! 31 equal steps to the octave\n31-EDO\n31\n";
+    for (int step = 1; step <= 31; ++step) text << juce::String(step * 1200.0 / 31, 5) << "\n";
+    scala->getFile().replaceWithText(text);
+  }
+  for (bool big : {false, true}) {
+    cases.push_back({"Processor", big ? "32 partials, 8 voices" : "pentatonic, 1 voice",
+                     [big, scala](double sampleRate, int blockSize) -> Block {
+      auto processor = std::make_shared<AudioPluginAudioProcessor>();
+      processor->setRenderSeed(1);
+      processor->setAssetDirectory(juce::File(KY_ASSET_DIRECTORY));
+      auto set = [&processor](const char* id, float value) {
+        auto* parameter = processor->apvts.getParameter(id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+      };
+      set("gain", -6.0f);
+      if (big) {
+        processor->loadScalaFile(scala->getFile());
+        set("scale", static_cast<float>(Tuning::numModes));
+        set("unison", static_cast<float>(AdditiveSynth::maxUnison));
+      }
+      processor->setPlayConfigDetails(0, 2, sampleRate, blockSize);
+      processor->prepareToPlay(sampleRate, blockSize);
+
+      // the IR may still be loading in the background: re-prepare until it is in
+      for (int i = 0; i < 500 && processor->getImpulseResponseSize() <= 1; ++i) {
+        juce::Thread::sleep(10);
+        processor->prepareToPlay(sampleRate, blockSize);
+      }
+
+      auto buffer = std::make_shared<juce::AudioBuffer<float>>(2, blockSize);
+      auto midi = std::make_shared<juce::MidiBuffer>();
+      return [=] { processor->processBlock(*buffer, *midi); };
+    }});
+  }
+
+  juce::File assets(KY_ASSET_DIRECTORY);
+  for (auto name : {"church_ir.wav", "cave_ir.wav", "room_ir.wav"}) {
+    juce::File file = assets.getChildFile(name);
+    if (!file.existsAsFile()) {
+      std::cerr << "skipping missing IR " << file.getFullPathName() << std::endl;
+      continue;
+    }
+    cases.push_back({"Convolution", name, [file](double sampleRate, int blockSize) -> Block {
+      auto convolution = std::make_shared<juce::dsp::Convolution>();
+      // loaded before prepare(), so the IR is in place when prepare() returns
+      convolution->loadImpulseResponse(file, juce::dsp::Convolution::Stereo::yes,
+                                       juce::dsp::Convolution::Trim::no, 0);
+      juce::dsp::ProcessSpec spec;
+      spec.sampleRate = sampleRate;
+      spec.maximumBlockSize = static_cast<juce::uint32>(blockSize);
+      spec.numChannels = 2;
+      convolution->prepare(spec);
+
+      auto buffer = std::make_shared<juce::AudioBuffer<float>>(2, blockSize);
+      auto input = noiseBlock(blockSize);
+      return [=] {
+        buffer->copyFrom(0, 0, input.data(), blockSize);
+        buffer->copyFrom(1, 0, input.data(), blockSize);
+        juce::dsp::AudioBlock<float> block(*buffer);
+        convolution->process(juce::dsp::ProcessContextReplacing<float>(block));
+      };
+    }});
+  }
+
+  return cases;
+}
+
+void writeCsv(std::ostream& out, const std::vector<Result>& results) {
+  out << "name,variant,sample_rate,block_size,ns_per_sample\n";
+  for (const auto& r : results) {
+    out << r.name << "," << r.variant << "," << r.sampleRate << ","
+        << r.blockSize << "," << r.nsPerSample << "\n";
+  }
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results) {
+  out << "[\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    out << "  {\"name\": \"" << r.name << "\", \"variant\": \"" << r.variant
+        << "\", \"sample_rate\": " << r.sampleRate
+        << ", \"block_size\": " << r.blockSize
+        << ", \"ns_per_sample\": " << r.nsPerSample << "}"
+        << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "]\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  juce::ScopedJuceInitialiser_GUI initialiser;
+
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--json") {
+      options.json = true;
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      options.seconds = std::stod(argv[++i]);
+    } else if (arg == "--filter" && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (arg == "--output" && i + 1 < argc) {
+      options.output = argv[++i];
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--json] [--seconds S] [--filter substring] [--output file]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  juce::ScopedNoDenormals noDenormals;
+  std::vector<Result> results;
+
+  for (const auto& c : makeCases()) {
+    if (!options.filter.empty() &&
+        (c.name + " " + c.variant).find(options.filter) == std::string::npos)
+      continue;
+
+    for (double sampleRate : sampleRates) {
+      // ky objects pick up the current rate when they are constructed
+      ky::setPlaybackRate(static_cast<float>(sampleRate));
+      for (int blockSize : blockSizes) {
+        Block block = c.setup(sampleRate, blockSize);
+        double ns = measure(block, sampleRate, blockSize, options.seconds);
+        results.push_back({c.name, c.variant, sampleRate, blockSize, ns});
+        std::cerr << c.name << " (" << c.variant << ") " << sampleRate << " Hz, "
+                  << blockSize << " samples: " << ns << " ns/sample" << std::endl;
+      }
+    }
+  }
+
+  std::ofstream file;
+  if (!options.output.empty()) file.open(options.output);
+  std::ostream& out = options.output.empty() ? std::cout : file;
+
+  if (options.json)
+    writeJson(out, results);
+  else
+    writeCsv(out, results);
+
+  return 0;
+}
@@ -1,38 +1,275 @@
+// Offline convolver: renders each input file through one impulse response and
+// writes the result next to it (or into --output), e.g. to pre-render reverb
+// beds. Files are streamed through the convolution in fixed-size blocks, so
+// memory stays flat however long they are, and several files are rendered at
+// once, one per worker thread.
+//
+//   convolution --ir file.wav [--block N] [--jobs N] [--bits 16|24|32]
+//               [--no-tail] [--output directory] input.wav...
+//
+// Each output is stereo and, unless --no-tail, runs on past the end of its
+// input for the length of the IR so the reverb is not cut off. Throughput is
+// reported per file and overall, in sample frames per second.
+
 #include <JuceHeader.h>
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " <path_to_wav_file>" << std::endl;
-        return 1;
+namespace {
+
+struct Options {
+  juce::File ir;
+  juce::File output;  // empty: write next to each input
+  int blockSize = 1024;
+  int jobs = 0;  // 0: one per core
+  int bits = 32;
+  bool tail = true;
+  std::vector<juce::File> inputs;
+};
+
+struct ImpulseResponse {
+  juce::AudioBuffer<float> audio;
+  double sampleRate = 0;
+};
+
+struct Outcome {
+  bool ok = false;
+  juce::String message;
+  juce::int64 frames = 0;
+  double seconds = 0;
+};
+
+constexpr int numOutputChannels = 2;
+
+std::mutex consoleLock;
+
+void report(const juce::String& line) {
+  const std::lock_guard<std::mutex> lock(consoleLock);
+  std::cerr << line << '\n';
+}
+
+bool readImpulseResponse(const juce::File& file, ImpulseResponse& ir) {
+  juce::AudioFormatManager formats;
+  formats.registerBasicFormats();
+  std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+  if (reader == nullptr || reader->lengthInSamples <= 0) return false;
+
+  ir.sampleRate = reader->sampleRate;
+  ir.audio.setSize(juce::jmin(2, static_cast<int>(reader->numChannels)),
+                   static_cast<int>(reader->lengthInSamples));
+  return reader->read(&ir.audio, 0, ir.audio.getNumSamples(), 0, true, true);
+}
+
+// One per worker thread: a convolution engine plus the block buffer, reused
+// for every file the worker renders.
+class Renderer {
+ public:
+  Renderer(const ImpulseResponse& ir, const Options& optionsToUse)
+      : impulse(ir), options(optionsToUse), block(numOutputChannels, options.blockSize) {
+    formats.registerBasicFormats();
+  }
+
+  Outcome render(const juce::File& input, const juce::File& destination) {
+    Outcome outcome;
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+    if (reader == nullptr) {
+      outcome.message = "can't read " + input.getFullPathName();
+      return outcome;
     }
 
-    juce::dsp::Convolution convolution;
+    if (!prepare(reader->sampleRate)) {
+      outcome.message = "the impulse response did not load";
+      return outcome;
+    }
 
-    juce::File file(argv[1]);
-    if (!file.exists()) {
-        std::cout << "File does not exist" << std::endl;
-        return 1;
+    // FileOutputStream appends, so start from an empty file
+    destination.deleteFile();
+    auto stream = destination.createOutputStream();
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        stream == nullptr ? nullptr
+                          : wav.createWriterFor(stream.get(), reader->sampleRate,
+                                                numOutputChannels, options.bits, {}, 0));
+    if (writer == nullptr) {
+      outcome.message = "can't write " + destination.getFullPathName();
+      return outcome;
     }
+    stream.release();  // the writer owns it now
 
-    convolution.loadImpulseResponse(file, juce::dsp::Convolution::Stereo::yes, juce::dsp::Convolution::Trim::no, 0);
+    const juce::int64 length = reader->lengthInSamples;
+    const juce::int64 total = length + (options.tail ? convolution.getCurrentIRSize() : 0);
+    const bool mono = reader->numChannels == 1;
 
-    convolution.reset();
+    auto start = std::chrono::steady_clock::now();
+    for (juce::int64 position = 0; position < total;) {
+      int count = static_cast<int>(juce::jmin<juce::int64>(options.blockSize, total - position));
+      juce::AudioBuffer<float> audio(block.getArrayOfWritePointers(), numOutputChannels, count);
+
+      // past the end of the input the reader pads with silence: that is the tail
+      reader->read(&audio, 0, count, position, true, !mono);
+      if (mono) audio.copyFrom(1, 0, audio, 0, 0, count);
+
+      juce::dsp::AudioBlock<float> audioBlock(audio);
+      convolution.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+
+      if (!writer->writeFromAudioSampleBuffer(audio, 0, count)) {
+        outcome.message = "write failed for " + destination.getFullPathName();
+        return outcome;
+      }
+      position += count;
+    }
+    writer.reset();  // flush before the clock stops
+    auto end = std::chrono::steady_clock::now();
+
+    outcome.ok = true;
+    outcome.frames = total;
+    outcome.seconds = std::chrono::duration<double>(end - start).count();
+    return outcome;
+  }
+
+ private:
+  // (Re)build the engine for a sample rate; between files at the same rate a
+  // reset() is all it needs.
+  bool prepare(double sampleRate) {
+    if (sampleRate == preparedRate) {
+      convolution.reset();
+      return true;
+    }
+
+    // loaded before prepare(), the IR is normally installed synchronously
+    juce::AudioBuffer<float> copy(impulse.audio);
+    convolution.loadImpulseResponse(std::move(copy), impulse.sampleRate,
+                                    impulse.audio.getNumChannels() > 1
+                                        ? juce::dsp::Convolution::Stereo::yes
+                                        : juce::dsp::Convolution::Stereo::no,
+                                    juce::dsp::Convolution::Trim::no,
+                                    juce::dsp::Convolution::Normalise::yes);
 
     juce::dsp::ProcessSpec spec;
-    spec.sampleRate = 48000;
-    spec.maximumBlockSize = 1024;
-    spec.numChannels = 2;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(options.blockSize);
+    spec.numChannels = numOutputChannels;
+
+    // if it went to the background loader instead, wait for it
     convolution.prepare(spec);
+    for (int i = 0; i < 500 && convolution.getCurrentIRSize() <= 1; ++i) {
+      juce::Thread::sleep(10);
+      convolution.prepare(spec);
+    }
+    convolution.reset();
 
-    juce::AudioBuffer<float> buffer(1, 200000);
-    buffer.clear();
-    buffer.setSample(0, 0, 1.0f);
+    preparedRate = convolution.getCurrentIRSize() > 1 ? sampleRate : 0;
+    return preparedRate > 0;
+  }
 
-    juce::dsp::AudioBlock<float> block(buffer);
-    convolution.process(juce::dsp::ProcessContextReplacing<float>(block));
-    for (int i = 0; i < buffer.getNumSamples(); ++i) {
-        std::cout << buffer.getSample(0, i) << std::endl;
+  const ImpulseResponse& impulse;
+  const Options& options;
+  juce::AudioFormatManager formats;
+  juce::dsp::Convolution convolution;
+  juce::AudioBuffer<float> block;
+  double preparedRate = 0;
+};
+
+juce::File destinationFor(const juce::File& input, const Options& options) {
+  auto directory = options.output == juce::File() ? input.getParentDirectory() : options.output;
+  return directory.getChildFile(input.getFileNameWithoutExtension() + "_" +
+                                options.ir.getFileNameWithoutExtension() + ".wav");
+}
+
+bool parse(int argc, char* argv[], Options& options) {
+  auto cwd = juce::File::getCurrentWorkingDirectory();
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--ir" && i + 1 < argc) {
+      options.ir = cwd.getChildFile(argv[++i]);
+    } else if (arg == "--block" && i + 1 < argc) {
+      options.blockSize = std::stoi(argv[++i]);
+    } else if (arg == "--jobs" && i + 1 < argc) {
+      options.jobs = std::stoi(argv[++i]);
+    } else if (arg == "--bits" && i + 1 < argc) {
+      options.bits = std::stoi(argv[++i]);
+    } else if (arg == "--output" && i + 1 < argc) {
+      options.output = cwd.getChildFile(argv[++i]);
+    } else if (arg == "--no-tail") {
+      options.tail = false;
+    } else if (arg.rfind("--", 0) == 0) {
+      return false;
+    } else {
+      options.inputs.push_back(cwd.getChildFile(arg));
     }
+  }
+  return options.ir != juce::File() && !options.inputs.empty() && options.blockSize > 0 &&
+         (options.bits == 16 || options.bits == 24 || options.bits == 32);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  juce::ScopedJuceInitialiser_GUI initialiser;
+
+  Options options;
+  if (!parse(argc, argv, options)) {
+    std::cerr << "Usage: " << argv[0]
+              << " --ir file.wav [--block N] [--jobs N] [--bits 16|24|32]"
+                 " [--no-tail] [--output directory] input.wav..."
+              << std::endl;
+    return 1;
+  }
+
+  ImpulseResponse ir;
+  if (!readImpulseResponse(options.ir, ir)) {
+    std::cerr << "Can't read impulse response " << options.ir.getFullPathName() << std::endl;
+    return 1;
+  }
+  if (options.output != juce::File() && !options.output.createDirectory()) {
+    std::cerr << "Can't create " << options.output.getFullPathName() << std::endl;
+    return 1;
+  }
+
+  int jobs = options.jobs > 0 ? options.jobs : juce::SystemStats::getNumCpus();
+  jobs = juce::jlimit(1, static_cast<int>(options.inputs.size()), jobs);
+
+  std::atomic<size_t> next{0};
+  std::atomic<juce::int64> frames{0};
+  std::atomic<int> failures{0};
+
+  auto work = [&] {
+    juce::ScopedNoDenormals noDenormals;
+    Renderer renderer(ir, options);
+    for (size_t i; (i = next++) < options.inputs.size();) {
+      const auto& input = options.inputs[i];
+      auto destination = destinationFor(input, options);
+      Outcome outcome = renderer.render(input, destination);
+      if (!outcome.ok) {
+        ++failures;
+        report(input.getFileName() + ": " + outcome.message);
+        continue;
+      }
+      frames += outcome.frames;
+      report(input.getFileName() + " -> " + destination.getFileName() + ": " +
+             juce::String(outcome.frames) + " frames, " +
+             juce::String(outcome.frames / juce::jmax(outcome.seconds, 1e-9), 0) + " frames/s");
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int i = 1; i < jobs; ++i) workers.emplace_back(work);
+  work();
+  for (auto& worker : workers) worker.join();
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << options.inputs.size() - static_cast<size_t>(failures.load()) << " of "
+            << options.inputs.size() << " files, " << frames.load() << " frames in "
+            << seconds << " s on " << jobs << " threads: "
+            << static_cast<double>(frames.load()) / seconds << " frames/s" << std::endl;
+  return failures > 0 ? 1 : 0;
 }
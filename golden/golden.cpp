@@ -0,0 +1,276 @@
+// Golden-render regression test. Each scenario renders the processor with a
+// fixed seed and a fixed automation script, at several block sizes, and
+// compares every render against one stored reference. A scenario passes when
+// the max absolute error and the SNR are within its tolerance, so both
+// numerical changes (vectorization, fast math) and block-size dependence are
+// caught.
+//
+//   Golden [--update] [--ci] [--references directory]
+//
+// --update rewrites the references from the current build. A missing
+// reference is recorded and reported; with --ci it is a failure instead.
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "PluginProcessor.h"
+
+namespace {
+
+constexpr double sampleRate = 48000;
+constexpr uint64_t seed = 240;
+const int blockSizes[] = {64, 512, 1000};
+
+struct Automation {
+  double seconds;
+  const char* parameter;
+  float value;  // normalised
+};
+
+struct Note {
+  double seconds;
+  int note;
+  float velocity;
+};
+
+struct Scenario {
+  const char* name;
+  double seconds;
+  std::vector<Automation> automation;  // entries at 0 s are set before prepare
+  std::vector<Note> notes;
+  float maxError;
+  float minSnr;  // dB
+};
+
+// a quiet pad, dry, changing chord every 3 seconds
+std::vector<Automation> base(float reverbMix = 0) {
+  return {{0, "gain", 0.8f},      {0, "frequency", 0.5f}, {0, "chordRate", 0},
+          {0, "sineMix", 0.3f},   {0, "sawMix", 0.5f},    {0, "triMix", 0.2f},
+          {0, "cutoff", 0.2f},    {0, "lfoDepth", 0.2f},  {0, "pluckMix", 0},
+          {0, "reverbMix", reverbMix}, {0, "irChoice", 0}};
+}
+
+std::vector<Scenario> scenarios() {
+  std::vector<Scenario> list;
+
+  list.push_back({"pad", 7, base(), {}, 1e-5f, 90});
+
+  Scenario sweep{"sweep", 4, base(), {}, 1e-5f, 90};
+  for (int i = 1; i < 16; ++i) {
+    double t = i * 0.25;
+    float x = i / 16.0f;
+    sweep.automation.push_back({t, "cutoff", x});
+    sweep.automation.push_back({t, "lfoDepth", 1 - x});
+    sweep.automation.push_back({t, "sineMix", x});
+    sweep.automation.push_back({t, "sawMix", 1 - x});
+    sweep.automation.push_back({t, "triMix", 0.5f * x});
+  }
+  list.push_back(sweep);
+
+  Scenario plucks{"plucks", 4, base(), {}, 1e-5f, 90};
+  plucks.automation.push_back({0, "pluckMix", 1});
+  for (int i = 0; i < 12; ++i)
+    plucks.notes.push_back({0.1 + i * 0.3173, 52 + (i * 7) % 24, 0.4f + 0.05f * i});
+  list.push_back(plucks);
+
+  // convolution rounding depends on the partition size, so this is looser
+  list.push_back({"church", 4, base(0.5f), {}, 1e-4f, 70});
+
+  return list;
+}
+
+// Renders a scenario in blocks of (at most) blockSize samples. Blocks are also
+// split at automation points, the way a host with sample-accurate automation
+// would, so every render sees each change on the same sample.
+juce::AudioBuffer<float> render(const Scenario& scenario, int blockSize) {
+  AudioPluginAudioProcessor processor;
+  processor.setRenderSeed(seed);
+  processor.setAssetDirectory(juce::File(KY_ASSET_DIRECTORY));
+
+  auto set = [&](const Automation& a) {
+    processor.apvts.getParameter(a.parameter)->setValueNotifyingHost(a.value);
+  };
+
+  auto total = static_cast<int>(scenario.seconds * sampleRate);
+  std::vector<Automation> pending;
+  for (const auto& a : scenario.automation) {
+    if (a.seconds <= 0)
+      set(a);
+    else
+      pending.push_back(a);
+  }
+
+  processor.setPlayConfigDetails(0, 2, sampleRate, blockSize);
+  processor.prepareToPlay(sampleRate, blockSize);
+
+  // the IR may still be loading in the background: re-prepare until it is in
+  for (int i = 0; i < 500 && processor.getImpulseResponseSize() <= 1; ++i) {
+    juce::Thread::sleep(10);
+    processor.prepareToPlay(sampleRate, blockSize);
+  }
+
+  juce::AudioBuffer<float> output(2, total);
+  output.clear();
+  juce::MidiBuffer midi;
+
+  int position = 0;
+  size_t next = 0;
+  while (position < total) {
+    while (next < pending.size() &&
+           static_cast<int>(pending[next].seconds * sampleRate) <= position)
+      set(pending[next++]);
+
+    int end = juce::jmin(total, position + blockSize);
+    if (next < pending.size())
+      end = juce::jmin(end, static_cast<int>(pending[next].seconds * sampleRate));
+
+    midi.clear();
+    for (const auto& n : scenario.notes) {
+      auto at = static_cast<int>(n.seconds * sampleRate);
+      if (at >= position && at < end)
+        midi.addEvent(juce::MidiMessage::noteOn(1, n.note, n.velocity), at - position);
+    }
+
+    juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), 2,
+                                   position, end - position);
+    processor.processBlock(block, midi);
+    position = end;
+  }
+
+  return output;
+}
+
+bool writeReference(const juce::File& file, const juce::AudioBuffer<float>& audio) {
+  file.getParentDirectory().createDirectory();
+  file.deleteFile();
+  std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+  if (stream == nullptr) return false;
+
+  juce::WavAudioFormat wav;
+  std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(
+      stream.get(), sampleRate, 2, 32, {}, 0));
+  if (writer == nullptr) return false;
+  stream.release();  // the writer owns it now
+
+  return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+}
+
+bool readReference(const juce::File& file, juce::AudioBuffer<float>& audio) {
+  juce::WavAudioFormat wav;
+  std::unique_ptr<juce::AudioFormatReader> reader(
+      wav.createReaderFor(file.createInputStream().release(), true));
+  if (reader == nullptr) return false;
+
+  audio.setSize(static_cast<int>(reader->numChannels),
+                static_cast<int>(reader->lengthInSamples));
+  return reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+}
+
+struct Comparison {
+  float maxError = 0;
+  double snr = 0;
+  bool nonFinite = false;
+};
+
+Comparison compare(const juce::AudioBuffer<float>& reference,
+                   const juce::AudioBuffer<float>& render) {
+  Comparison c;
+  double signal = 0, noise = 0;
+  for (int channel = 0; channel < 2; ++channel) {
+    const float* a = reference.getReadPointer(channel);
+    const float* b = render.getReadPointer(channel);
+    for (int i = 0; i < render.getNumSamples(); ++i) {
+      if (!std::isfinite(b[i])) c.nonFinite = true;
+      float e = std::abs(a[i] - b[i]);
+      c.maxError = std::max(c.maxError, e);
+      signal += static_cast<double>(a[i]) * a[i];
+      noise += static_cast<double>(e) * e;
+    }
+  }
+  c.snr = noise > 0 ? 10 * std::log10(signal / noise)
+                    : std::numeric_limits<double>::infinity();
+  return c;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  juce::ScopedJuceInitialiser_GUI initialiser;
+
+  bool update = false, ci = false;
+  juce::File references(KY_GOLDEN_DIRECTORY);
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--update") {
+      update = true;
+    } else if (arg == "--ci") {
+      ci = true;
+    } else if (arg == "--references" && i + 1 < argc) {
+      references = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--update] [--ci] [--references directory]" << std::endl;
+      return 1;
+    }
+  }
+
+  int failures = 0;
+  for (const auto& scenario : scenarios()) {
+    juce::File file = references.getChildFile(juce::String(scenario.name) + ".wav");
+
+    juce::AudioBuffer<float> reference;
+    if (update || !file.existsAsFile()) {
+      if (!update && ci) {
+        std::cout << scenario.name << ": FAIL (no reference at "
+                  << file.getFullPathName() << ")" << std::endl;
+        ++failures;
+        continue;
+      }
+      reference = render(scenario, blockSizes[0]);
+      if (!writeReference(file, reference)) {
+        std::cout << scenario.name << ": FAIL (couldn't write "
+                  << file.getFullPathName() << ")" << std::endl;
+        ++failures;
+        continue;
+      }
+      std::cout << scenario.name << ": recorded " << file.getFullPathName() << std::endl;
+    } else if (!readReference(file, reference)) {
+      std::cout << scenario.name << ": FAIL (couldn't read "
+                << file.getFullPathName() << ")" << std::endl;
+      ++failures;
+      continue;
+    }
+
+    for (int blockSize : blockSizes) {
+      auto audio = render(scenario, blockSize);
+      bool sameShape = reference.getNumChannels() == 2 &&
+                       reference.getNumSamples() == audio.getNumSamples();
+      Comparison c;
+      if (sameShape) c = compare(reference, audio);
+
+      bool pass = sameShape && !c.nonFinite && c.maxError <= scenario.maxError &&
+                  c.snr >= scenario.minSnr;
+      if (!pass) ++failures;
+
+      std::cout << scenario.name << " @ " << blockSize << ": "
+                << (pass ? "pass" : "FAIL");
+      if (!sameShape)
+        std::cout << " (reference has a different length or channel count)";
+      else
+        std::cout << " (max error " << c.maxError << " <= " << scenario.maxError
+                  << ", SNR " << c.snr << " dB >= " << scenario.minSnr << " dB"
+                  << (c.nonFinite ? ", non-finite output" : "") << ")";
+      std::cout << std::endl;
+    }
+  }
+
+  std::cout << (failures == 0 ? "all golden renders match"
+                              : std::to_string(failures) + " failure(s)")
+            << std::endl;
+  return failures == 0 ? 0 : 1;
+}
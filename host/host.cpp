@@ -0,0 +1,186 @@
+// Startup-time benchmark. Loads the built VST3 through
+// juce::AudioPluginFormatManager, as a DAW opening a session would, and times
+// each step of bringing up 1, 2, 5, ... instances of it, all kept alive:
+//
+//   construct   createPluginInstance (the processor and its apvts)
+//   restore     setStateInformation with a saved program
+//   prepare     prepareToPlay (loads the IR)
+//   process     the first processBlock
+//   editor      createEditor (decodes the backdrops), then closed again
+//
+//   Host [--plugin path] [--instances n] [--sample-rate r] [--block-size n]
+//        [--no-editor]
+//
+// Prints the first, mean and slowest time of each step for every count, and
+// the time to bring up the whole count. The module itself is loaded (and its
+// load time left out) before the first count, by the instance the restored
+// state is saved from.
+
+#include <JuceHeader.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  juce::String plugin = KY_PLUGIN_PATH;
+  int instances = 100;
+  double sampleRate = 48000;
+  int blockSize = 512;
+  bool editor = true;
+};
+
+enum Step { construct, restore, prepare, process, editor, numSteps };
+const char* stepNames[] = {"construct", "restore", "prepare", "process", "editor"};
+
+struct Timing {
+  std::vector<double> milliseconds[numSteps];  // per instance
+  double total = 0;
+};
+
+class Stopwatch {
+ public:
+  double lap() {
+    double now = juce::Time::getMillisecondCounterHiRes();
+    double elapsed = now - last;
+    last = now;
+    return elapsed;
+  }
+
+ private:
+  double last = juce::Time::getMillisecondCounterHiRes();
+};
+
+// brings up `count` instances one after the other; false if one fails to load
+bool bringUp(juce::AudioPluginFormatManager& formats, const juce::PluginDescription& description,
+             const juce::MemoryBlock& state, const Options& options, int count, Timing& timing) {
+  std::vector<std::unique_ptr<juce::AudioPluginInstance>> instances;
+  juce::AudioBuffer<float> buffer;
+  juce::MidiBuffer midi;
+  Stopwatch session;
+
+  for (int i = 0; i < count; ++i) {
+    Stopwatch watch;
+    juce::String error;
+    auto instance = formats.createPluginInstance(description, options.sampleRate,
+                                                 options.blockSize, error);
+    if (instance == nullptr) {
+      std::cerr << "couldn't load " << description.fileOrIdentifier << ": " << error << std::endl;
+      return false;
+    }
+    timing.milliseconds[construct].push_back(watch.lap());
+
+    instance->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    timing.milliseconds[restore].push_back(watch.lap());
+
+    instance->setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+    instance->prepareToPlay(options.sampleRate, options.blockSize);
+    timing.milliseconds[prepare].push_back(watch.lap());
+
+    buffer.setSize(juce::jmax(instance->getTotalNumInputChannels(),
+                              instance->getTotalNumOutputChannels()),
+                   options.blockSize);
+    buffer.clear();
+    midi.clear();
+    watch.lap();  // not the buffer
+    instance->processBlock(buffer, midi);
+    timing.milliseconds[process].push_back(watch.lap());
+
+    if (options.editor) {
+      std::unique_ptr<juce::AudioProcessorEditor> view(instance->createEditorIfNeeded());
+      timing.milliseconds[editor].push_back(watch.lap());
+    }
+
+    instances.push_back(std::move(instance));
+  }
+  timing.total = session.lap();
+
+  for (auto& instance : instances) instance->releaseResources();
+  return true;
+}
+
+void print(int count, const Timing& timing) {
+  std::cout << count << (count == 1 ? " instance" : " instances") << ": "
+            << timing.total << " ms" << std::endl;
+  for (int s = 0; s < numSteps; ++s) {
+    const auto& times = timing.milliseconds[s];
+    if (times.empty()) continue;
+    double sum = 0, slowest = 0;
+    for (double t : times) {
+      sum += t;
+      slowest = juce::jmax(slowest, t);
+    }
+    std::cout << "  " << stepNames[s] << ": first " << times.front() << " ms, mean "
+              << sum / static_cast<double>(times.size()) << " ms, slowest " << slowest
+              << " ms" << std::endl;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  juce::ScopedJuceInitialiser_GUI initialiser;
+
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--plugin" && hasValue) {
+      options.plugin = argv[++i];
+    } else if (arg == "--instances" && hasValue) {
+      options.instances = juce::jmax(1, std::stoi(argv[++i]));
+    } else if (arg == "--sample-rate" && hasValue) {
+      options.sampleRate = std::stod(argv[++i]);
+    } else if (arg == "--block-size" && hasValue) {
+      options.blockSize = juce::jmax(1, std::stoi(argv[++i]));
+    } else if (arg == "--no-editor") {
+      options.editor = false;
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--plugin path] [--instances n] [--sample-rate r] [--block-size n]"
+                   " [--no-editor]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  juce::AudioPluginFormatManager formats;
+  formats.addFormat(new juce::VST3PluginFormat());
+
+  Stopwatch scan;
+  juce::OwnedArray<juce::PluginDescription> found;
+  formats.getFormat(0)->findAllTypesForFile(found, options.plugin);
+  if (found.isEmpty()) {
+    std::cerr << "no VST3 plugin at " << options.plugin << std::endl;
+    return 1;
+  }
+  const juce::PluginDescription description = *found.getFirst();
+  std::cout << description.name << " (" << options.plugin << "), scanned in " << scan.lap()
+            << " ms" << std::endl;
+
+  // the state a session would restore: a factory program other than Init
+  juce::MemoryBlock state;
+  {
+    juce::String error;
+    auto instance = formats.createPluginInstance(description, options.sampleRate,
+                                                 options.blockSize, error);
+    if (instance == nullptr) {
+      std::cerr << "couldn't load " << options.plugin << ": " << error << std::endl;
+      return 1;
+    }
+    instance->setCurrentProgram(juce::jmin(1, instance->getNumPrograms() - 1));
+    instance->getStateInformation(state);
+  }
+
+  for (int count : {1, 2, 5, 10, 20, 50, 100, 200, 500}) {
+    count = juce::jmin(count, options.instances);
+    Timing timing;
+    if (!bringUp(formats, description, state, options, count, timing)) return 1;
+    print(count, timing);
+    if (count == options.instances) break;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+// Pitch test. Renders the synth with a single sine partial at several
+// frequencies, with one voice and with unison, on each kernel variant (see
+// Dispatch.h), and measures the period from the rising zero crossings. A pass
+// means every render is within tolerance of the partial's own frequency: an
+// error in the phase accumulators (a step off by an octave, say) fails by far.
+//
+//   Pitch
+
+#include <JuceHeader.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "AdditiveSynth.h"
+#include "Dispatch.h"
+
+namespace {
+
+constexpr double sampleRate = 48000;
+constexpr int blockSize = 512;
+constexpr double tolerance = 1e-4;  // relative
+
+// the frequency of `samples`, from the first to the last rising zero crossing,
+// each placed between its two samples by linear interpolation
+double measureFrequency(const std::vector<float>& samples) {
+  double first = -1, last = -1;
+  int crossings = 0;
+  for (size_t i = 1; i < samples.size(); ++i) {
+    if (samples[i - 1] < 0 && samples[i] >= 0) {
+      double at = static_cast<double>(i - 1) + samples[i - 1] / (samples[i - 1] - samples[i]);
+      if (first < 0) first = at;
+      last = at;
+      ++crossings;
+    }
+  }
+  if (crossings < 2) return 0;
+  return (crossings - 1) * sampleRate / (last - first);
+}
+
+// measured / expected frequency of one partial at `frequency`
+double render(float frequency, int voices) {
+  AdditiveSynth synth;
+  synth.prepare(sampleRate, blockSize);
+  synth.setThreadLimit(1);
+  synth.setMixingRatios(1, 0, 0);
+  synth.setFilterCutoff(18000);
+  synth.setUnison(voices, 0, 0);
+  const float ratio = 1;
+  synth.setChord(frequency, &ratio, 1);
+
+  // the first second is the envelope's attack; the next is measured
+  const auto total = static_cast<int>(2 * sampleRate);
+  std::vector<float> left(static_cast<size_t>(total)), right(left.size());
+  for (int start = 0; start < total; start += blockSize) {
+    int count = juce::jmin(blockSize, total - start);
+    synth.render(left.data() + start, right.data() + start, count);
+  }
+
+  std::vector<float> measured(left.begin() + total / 2, left.end());
+  return measureFrequency(measured) / synth.getHarmonicFrequency(0);
+}
+
+}  // namespace
+
+int main() {
+  juce::ScopedJuceInitialiser_GUI initialiser;
+
+  bool pass = true;
+  for (auto isa : {ky::Isa::generic, ky::Isa::avx2, ky::Isa::avx512}) {
+    ky::setIsa(isa);
+    for (float frequency : {55.0f, 110.0f, 440.0f, 1760.0f}) {
+      for (int voices : {1, 3, AdditiveSynth::maxUnison}) {
+        double ratio = render(frequency, voices);
+        bool ok = std::abs(ratio - 1) < tolerance;
+        pass = pass && ok;
+        std::cout << ky::getIsaName(ky::getIsa()) << ", " << frequency << " Hz, " << voices
+                  << " voice(s): " << ratio << " of the partial's frequency"
+                  << (ok ? "" : "  FAIL") << std::endl;
+      }
+    }
+  }
+
+  if (pass) std::cout << "pass" << std::endl;
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+// Worst-case callback stress test. The processor is prepared for 512-sample
+// blocks and then driven with random block sizes from 1 to 8192 (most of
+// them past the prepared size), dense random automation of every parameter,
+// irChoice, clipKey and clipTaps switched every few blocks, random note-ons,
+// and the sample file reopened from the message thread every few hundred ms
+// (one of the IRs, so the stream layer's lock and the resampler's tap changes
+// run under load), for a fixed length of audio. Every processBlock call is
+// timed.
+//
+//   Stress [--seconds s] [--budget fraction] [--quantile q] [--density p] [--seed n]
+//
+// The test fails on any non-finite output. With a budget it also fails if
+// the call at `quantile` of the loads (by default p99.9, so one preemption
+// by the OS does not decide it; 1 is the slowest) takes more than `budget`
+// of its block's duration. A call's deadline is counted as at least
+// minimumDeadline samples: hosts split their buffers into tiny blocks at
+// automation points, and those share the deadline of the whole buffer.
+// Timing depends on the machine and the build, so the budget is off unless
+// given; see CMakeLists.txt for how ctest runs it.
+//
+// The audio runs on its own thread while this one runs the message loop, as
+// in a host, so the spare IRs are refilled between switches and the sample
+// file is swapped against the audio thread.
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PluginProcessor.h"
+
+namespace {
+
+constexpr double sampleRate = 48000;
+constexpr int preparedBlockSize = 512;
+constexpr int maximumBlockSize = 8192;
+constexpr int minimumDeadline = 64;  // samples
+constexpr int warmUpBlocks = 50;     // first touches of every buffer; not timed
+
+struct Options {
+  double seconds = 60;
+  double budget = 0;      // of the block duration; 0 is no budget
+  double quantile = 0.999;
+  double density = 0.25;  // chance per block that each parameter moves
+  int64_t seed = 1;
+};
+
+struct Call {
+  double seconds;
+  double load;  // of the deadline
+  int numSamples;
+};
+
+struct Result {
+  std::vector<Call> calls;
+  int nonFinite = 0;  // blocks with a NaN or infinity in them
+  int irSwitches = 0;
+  int clipChanges = 0;  // of clipKey or clipTaps
+  double audioSeconds = 0;
+};
+
+// Reopens the sample file, one of the IRs picked at random, at random
+// intervals of 100 to 400 ms, on the message thread as an editor would
+class SampleSwitcher : private juce::Timer {
+ public:
+  SampleSwitcher(AudioPluginAudioProcessor& p, int64_t seed) : processor(p), random(seed) {
+    juce::File assets(KY_ASSET_DIRECTORY);
+    for (auto name : {"church_ir.wav", "cave_ir.wav", "room_ir.wav"})
+      files.add(assets.getChildFile(name));
+    timerCallback();
+  }
+  ~SampleSwitcher() override { stopTimer(); }
+
+  int getSwitches() const { return switches; }
+
+ private:
+  void timerCallback() override {
+    if (processor.openSampleFile(files[random.nextInt(files.size())])) ++switches;
+    startTimer(100 + random.nextInt(300));
+  }
+
+  AudioPluginAudioProcessor& processor;
+  juce::Random random;
+  juce::Array<juce::File> files;
+  int switches = 0;
+};
+
+// block sizes spread evenly over octaves, so tiny, typical and huge blocks
+// all come up often
+int randomBlockSize(juce::Random& random) {
+  double octaves = std::log2(static_cast<double>(maximumBlockSize));
+  auto size = static_cast<int>(std::exp2(random.nextDouble() * octaves));
+  return juce::jlimit(1, maximumBlockSize, size);
+}
+
+void run(AudioPluginAudioProcessor& processor, const Options& options, Result& result) {
+  juce::Random random(options.seed);
+  auto& parameters = processor.getParameters();
+  auto* irChoice = processor.apvts.getParameter("irChoice");
+  auto* clipKey = processor.apvts.getParameter("clipKey");
+  auto* clipTaps = processor.apvts.getParameter("clipTaps");
+
+  juce::AudioBuffer<float> output(2, maximumBlockSize);
+  juce::MidiBuffer midi;
+  midi.ensureSize(1024);
+  result.calls.reserve(static_cast<size_t>(options.seconds * sampleRate / 64));
+
+  auto total = static_cast<juce::int64>(options.seconds * sampleRate);
+  for (juce::int64 position = 0, block = 0; position < total; ++block) {
+    int numSamples = randomBlockSize(random);
+
+    for (auto* parameter : parameters)
+      if (random.nextDouble() < options.density)
+        parameter->setValueNotifyingHost(random.nextFloat());
+    if (random.nextInt(4) == 0) {
+      irChoice->setValueNotifyingHost(irChoice->convertTo0to1(
+          static_cast<float>(random.nextInt(3))));
+      ++result.irSwitches;
+    }
+    if (random.nextInt(4) == 0) {
+      clipKey->setValueNotifyingHost(clipKey->convertTo0to1(
+          static_cast<float>(random.nextInt(13))));
+      clipTaps->setValueNotifyingHost(clipTaps->convertTo0to1(
+          static_cast<float>(random.nextInt(4))));
+      ++result.clipChanges;
+    }
+
+    midi.clear();
+    if (random.nextInt(8) == 0)
+      midi.addEvent(juce::MidiMessage::noteOn(1, 40 + random.nextInt(40), random.nextFloat()),
+                    random.nextInt(numSamples));
+
+    output.clear();
+    juce::AudioBuffer<float> buffer(output.getArrayOfWritePointers(), 2, 0, numSamples);
+    auto start = juce::Time::getHighResolutionTicks();
+    processor.processBlock(buffer, midi);
+    auto seconds = juce::Time::highResolutionTicksToSeconds(
+        juce::Time::getHighResolutionTicks() - start);
+
+    bool finite = true;
+    for (int channel = 0; channel < 2; ++channel) {
+      const float* samples = buffer.getReadPointer(channel);
+      for (int i = 0; i < numSamples; ++i) finite = finite && std::isfinite(samples[i]);
+    }
+    if (!finite) ++result.nonFinite;
+
+    if (block >= warmUpBlocks) {
+      double deadline = juce::jmax(numSamples, minimumDeadline) / sampleRate;
+      result.calls.push_back({seconds, seconds / deadline, numSamples});
+    }
+    position += numSamples;
+  }
+  result.audioSeconds = static_cast<double>(total) / sampleRate;
+}
+
+// the value at `quantile` of the calls, by `key`
+template <typename Key>
+Call percentile(std::vector<Call> calls, double quantile, Key key) {
+  if (calls.empty()) return {0, 0, 0};
+  auto index = static_cast<size_t>(quantile * static_cast<double>(calls.size() - 1));
+  std::nth_element(calls.begin(), calls.begin() + static_cast<std::ptrdiff_t>(index),
+                   calls.end(), [key](const Call& a, const Call& b) { return key(a) < key(b); });
+  return calls[index];
+}
+
+void print(const char* label, const Call& call) {
+  std::cout << label << ": " << call.seconds * 1e6 << " us, " << call.load * 100
+            << "% of the deadline (" << call.numSamples << " samples)" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  juce::ScopedJuceInitialiser_GUI initialiser;
+
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--seconds" && hasValue) {
+      options.seconds = std::stod(argv[++i]);
+    } else if (arg == "--budget" && hasValue) {
+      options.budget = std::stod(argv[++i]);
+    } else if (arg == "--quantile" && hasValue) {
+      options.quantile = juce::jlimit(0.0, 1.0, std::stod(argv[++i]));
+    } else if (arg == "--density" && hasValue) {
+      options.density = std::stod(argv[++i]);
+    } else if (arg == "--seed" && hasValue) {
+      options.seed = std::stoll(argv[++i]);
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--seconds s] [--budget fraction] [--quantile q] [--density p] [--seed n]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  AudioPluginAudioProcessor processor;
+  processor.setRenderSeed(static_cast<uint64_t>(options.seed));
+  processor.setAssetDirectory(juce::File(KY_ASSET_DIRECTORY));
+  processor.setPlayConfigDetails(0, 2, sampleRate, preparedBlockSize);
+  processor.prepareToPlay(sampleRate, preparedBlockSize);
+
+  // the IR may still be loading in the background: re-prepare until it is in
+  for (int i = 0; i < 500 && processor.getImpulseResponseSize() <= 1; ++i) {
+    juce::Thread::sleep(10);
+    processor.prepareToPlay(sampleRate, preparedBlockSize);
+  }
+
+  Result result;
+  SampleSwitcher samples(processor, options.seed + 1);
+  std::thread audio([&] {
+    run(processor, options, result);
+    juce::MessageManager::getInstance()->stopDispatchLoop();
+  });
+  juce::MessageManager::getInstance()->runDispatchLoop();
+  audio.join();
+
+  auto bySeconds = [](const Call& c) { return c.seconds; };
+  auto byLoad = [](const Call& c) { return c.load; };
+  Call budgeted = percentile(result.calls, options.quantile, byLoad);
+
+  std::cout << result.calls.size() << " timed blocks, " << result.audioSeconds
+            << " s of audio, " << result.irSwitches << " irChoice changes, "
+            << result.clipChanges << " clipKey/clipTaps changes, " << samples.getSwitches()
+            << " sample files opened" << std::endl;
+  print("slowest call", percentile(result.calls, 1.0, bySeconds));
+  print("p99.9 call", percentile(result.calls, 0.999, bySeconds));
+  print("worst load", percentile(result.calls, 1.0, byLoad));
+  print("p99.9 load", percentile(result.calls, 0.999, byLoad));
+
+  bool overBudget = options.budget > 0 && budgeted.load > options.budget;
+  bool pass = result.nonFinite == 0 && !overBudget;
+  if (result.nonFinite > 0)
+    std::cout << "FAIL: " << result.nonFinite << " block(s) with non-finite output" << std::endl;
+  if (overBudget)
+    std::cout << "FAIL: load at quantile " << options.quantile << " " << budgeted.load * 100
+              << "% > budget " << options.budget * 100 << "%" << std::endl;
+  if (pass) std::cout << "pass" << std::endl;
+  return pass ? 0 : 1;
+}